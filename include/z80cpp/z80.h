@@ -76,14 +76,26 @@ typedef union {
 #define REG_Z   memptr.byte8.lo
 #define REG_WZ  memptr.word
 
-class Z80 {
+/* El núcleo es una plantilla sobre la clase que implementa el bus.
+ * Z80 (= Z80Core<Z80operations>) llama al bus a través de la interfaz
+ * virtual Z80operations. Un emulador que instancia Z80Core con su propia
+ * clase (marcada 'final') obtiene llamadas directas, que el compilador puede
+ * expandir en línea dentro de cada instrucción.
+ *
+ * The core is a template over the bus implementation. Z80 keeps the virtual
+ * Z80operations interface; Z80Core<YourBus> binds the bus at compile time.
+ * The template bodies live in z80_impl.h, include it only where the core is
+ * instantiated.
+ */
+template <class Z80ops>
+class Z80Core {
 public:
     // Modos de interrupción
     enum IntMode {
         IM0, IM1, IM2
     };
 private:
-    Z80operations *Z80opsImpl;
+    Z80ops *Z80opsImpl;
     // Código de instrucción a ejecutar
     // Poner esta variable como local produce peor rendimiento
     // ZEXALL test: (local) 1:54 vs 1:47 (visitante)
@@ -214,8 +226,8 @@ private:
 
 public:
     // Constructor de la clase
-    Z80(Z80operations *ops);
-    ~Z80(void);
+    Z80Core(Z80ops *ops);
+    ~Z80Core(void);
 
     // Acceso a registros de 8 bits
     // Access to 8-bit registers
@@ -384,6 +396,33 @@ public:
     // Execute one instruction
     void execute(void);
 
+    // Execute instructions until the bus T-state counter reaches tstateLimit.
+    // An instruction is never split: the counter may end past the limit.
+    // Returns early, with isHalted() true, when the CPU stops at a HALT.
+    void executeUntil(uint32_t tstateLimit);
+
+    // Account for 'steps' HALT refetches without executing them (R register
+    // and Q flag). The caller has already added their T-states (4 + contention
+    // per M1) and guarantees no INT/NMI is accepted in the skipped span.
+    void skipHalted(uint32_t steps);
+
+    // Snapshot of the whole CPU state except R. Two equal snapshots taken at
+    // the same PC bound a loop with no effect on the CPU (idle loop detection).
+    struct LoopState {
+        uint16_t word[15];
+        bool operator==(const LoopState& other) const {
+            for (int i = 0; i < 15; i++) {
+                if (word[i] != other.word[i])
+                    return false;
+            }
+            return true;
+        }
+    };
+    void getLoopState(LoopState& state) const;
+
+    // Add to R the M1 cycles of instructions skipped by the caller
+    void advanceRegR(uint32_t m1Cycles) { regR += static_cast<uint8_t>(m1Cycles); }
+
 #ifdef WITH_BREAKPOINT_SUPPORT
     bool isBreakpoint(void) { return breakpointEnabled; }
     void setBreakpoint(bool state) { breakpointEnabled = state; }
@@ -394,6 +433,16 @@ public:
 #endif
 
 private:
+    // Límite de executeUntil, para que las instrucciones de bloque puedan
+    // delegar en el bus las vueltas que caben antes (0 = una instrucción)
+    uint32_t burstLimit = 0;
+
+    // Cuerpo de execute(), expandido en línea dentro del bucle de executeUntil
+    inline void step(void);
+
+    // LDIR/LDDR/CPIR/CPDR: vueltas adicionales hechas en bloque por el bus
+    void repeatBlock(bool compare, int dir);
+
     // Rota a la izquierda el valor del argumento
     inline void rlc(uint8_t &oper8);
 
@@ -524,4 +573,9 @@ private:
     // Decode EDXX opcodes
     void decodeED(uint8_t opCode);
 };
+
+// Núcleo con bus virtual, instanciado en z80.cpp
+typedef Z80Core<Z80operations> Z80;
+extern template class Z80Core<Z80operations>;
+
 #endif // Z80CPP_H
@@ -33,6 +33,32 @@ public:
     /* Callback to know when the INT signal is active */
     virtual bool isActiveINT(void) = 0;
 
+    /* Current T-state counter, read by Z80::executeUntil to stop at a deadline.
+     * A bus that does not keep one can leave this default: executeUntil then
+     * sees no progress and runs a single instruction per call, like execute(). */
+    virtual uint32_t getTstates(void) {
+        return 0;
+    }
+
+    /* Optional fast path for LDIR/LDDR (CPIR/CPDR: compare against 'value').
+     * Run in bulk up to 'count' further iterations of the block instruction
+     * at 'pc', all of them repeating ones, with src/dst moving by 'step'.
+     * Each one must start below 'limit', and the INT line must not change
+     * meanwhile. Charge the exact timing (2 M1 + memory + wait states) and
+     * store the last byte moved/compared in 'last'. A compare run stops
+     * before the byte equal to 'value'. Return the iterations done
+     * (0 = not supported, the core keeps stepping). */
+    virtual uint16_t blockCopy(uint16_t /*pc*/, uint16_t /*src*/, uint16_t /*dst*/,
+                               uint16_t /*count*/, int /*step*/, uint32_t /*limit*/,
+                               uint8_t & /*last*/) {
+        return 0;
+    }
+    virtual uint16_t blockCompare(uint16_t /*pc*/, uint16_t /*src*/, uint16_t /*count*/,
+                                  int /*step*/, uint8_t /*value*/, uint32_t /*limit*/,
+                                  uint8_t & /*last*/) {
+        return 0;
+    }
+
 #ifdef WITH_BREAKPOINT_SUPPORT
     /* Callback for notify at PC address */
     virtual uint8_t breakpoint(uint16_t address, uint8_t opcode) = 0;
@@ -61,7 +61,10 @@ SDL_Texture*  texture  = NULL;
 #define FULL_HEIGHT 240
 #define SCALE		2
 
-uint32_t pixels[FULL_HEIGHT * FULL_WIDTH];
+// Memoria de la textura bloqueada durante el frame (se pinta directamente
+// en ella, sin buffer intermedio)
+uint8_t* frame_pixels = NULL;
+int frame_pitch = 0;
 static const int TOTAL_SCANLINES = 312;
 static const int TOP_BORDER_LINES = 64;
 static const int VISIBLE_LINES = 192;
@@ -97,6 +100,8 @@ const int16_t LOW_LEVEL = -8000;
 const double FILTER_ALPHA = 0.5;
 
 void load_bios(void);
+static void build_bitmap_masks(void);
+static void build_attr_colors(void);
 bool is_128k_mode = false;
 
 
@@ -134,16 +139,29 @@ void MinZX::interruptHandlingTime(int32_t wstates)
     intPending = false;
 }*/
 
-unsigned char delay_contention(uint16_t address, unsigned int tstates)
+// Contención: retardo de un acceso que empieza en cada T-estado del frame.
+// Primer acceso contenido en el T-estado 14335
+#define CONTENTION_TABLE_SIZE	(69888 + 256)
+uint8_t contention_table[CONTENTION_TABLE_SIZE];
+bool contended_page[4] = { false, true, false, false };
+
+void build_contention_table(uint32_t first_contended, uint32_t tstates_per_line)
+{
+    static const uint8_t wait_states[8] = { 6,5,4,3,2,1,0,0 };
+
+    memset(contention_table, 0, sizeof(contention_table));
+    for (uint32_t line = 0; line < VISIBLE_LINES; line++)
+    {
+        uint32_t base = first_contended + line * tstates_per_line;
+        for (uint32_t t = 0; t < TSTATES_ACTIVE_FETCH; t++)
+            contention_table[base + t] = wait_states[t % 8];
+    }
+}
+
+static inline unsigned char delay_contention(uint16_t address, unsigned int tstates)
 {
-    tstates += 1;
-    int line = tstates / 224;
-    if (line < 64 || line >= 256) return 0;
-    int halfpix = tstates % 224;
-    if (halfpix >= 128) return 0;
-    int modulo = halfpix % 8;
-    static unsigned char wait_states[8] = { 6,5,4,3,2,1,0,0 };
-    return wait_states[modulo];
+    if (!contended_page[address >> 14] || tstates >= CONTENTION_TABLE_SIZE) return 0;
+    return contention_table[tstates];
 }
 
 /*uint8_t MinZX::fetchOpcode(uint16_t address)
@@ -155,15 +173,13 @@ unsigned char delay_contention(uint16_t address, unsigned int tstates)
 }*/
 
 uint8_t read_byte(void* ud, uint16_t address) {
-	if ((address >> 14) == 1)
-        addTstates(delay_contention(address, tstates));
+	addTstates(delay_contention(address, tstates));
     addTstates(3);
     return mem[address];
 }
 
 void write_byte(void* ud, uint16_t address, uint8_t value) {
-	if ((address >> 14) == 1)
-        addTstates(delay_contention(address, tstates));
+	addTstates(delay_contention(address, tstates));
     addTstates(3);
     mem[address] = value;
 }
@@ -185,7 +201,7 @@ void MinZX::poke16(uint16_t address, RegisterPair word)
 
 void addressOnBus(uint16_t address, int32_t wstates)
 {
-    if ((address >> 14) == 1)
+    if (contended_page[address >> 14])
     {
         for (int i = 0; i < wstates; i++)
             addTstates(delay_contention(address, tstates) + 1);
@@ -375,6 +391,11 @@ void init(void)
     memset(keyboard, 0xFF, sizeof(keyboard));
 
     cycleTstates = 69888;
+    // Siempre con el timing del 48K: el frame, las líneas y el bus flotante
+    // de este frontend no cambian con --128k (ni hay paginación de bancos)
+    build_contention_table(14335, TSTATES_PER_SCANLINE);
+    build_bitmap_masks();
+    build_attr_colors();
     load_bios();
 
     //createSpectrumColors();
@@ -411,6 +432,32 @@ bool load_rom(const char* fn) {
 // ─────────────────────────────────────────────────────────────
 // Vídeo
 // ─────────────────────────────────────────────────────────────
+// Tinta [0] y papel [1] de cada atributo en la fase de FLASH actual
+static uint32_t attr_colors[256][2];
+// Máscara de los 8 píxeles de cada byte de bitmap (0xFFFFFFFF = tinta)
+static uint32_t bitmap_mask[256][8];
+
+static void build_bitmap_masks(void)
+{
+    for (int pixels = 0; pixels < 256; pixels++)
+        for (int bit = 0; bit < 8; bit++)
+            bitmap_mask[pixels][bit] = (pixels & (0x80 >> bit)) ? 0xFFFFFFFF : 0;
+}
+
+// Hay que rehacerla al cambiar la paleta o la fase del FLASH
+static void build_attr_colors(void)
+{
+    for (int att = 0; att < 256; att++)
+    {
+        uint32_t ink = zx_colors[att & 7];          // el brillo no se aplica
+        uint32_t pap = zx_colors[(att >> 3) & 7];
+        bool swap = (att & 0x80) && _flash_act;
+
+        attr_colors[att][0] = swap ? pap : ink;
+        attr_colors[att][1] = swap ? ink : pap;
+    }
+}
+
 void renderScanline()
 {
 	//printf("Render!\n");
@@ -420,10 +467,10 @@ void renderScanline()
     uint32_t borderColor = zx_colors[border_color];
 
     int displayY = currentScanline - (TOP_BORDER_LINES - 24);
-    if (displayY < 0 || displayY >= 240)
+    if (displayY < 0 || displayY >= 240 || frame_pixels == NULL)
         return;
 
-    uint32_t* linePtr = (uint32_t*)(pixels + displayY * 320 /* *4 */);
+    uint32_t* linePtr = (uint32_t*)(frame_pixels + displayY * frame_pitch);
 
     if (currentScanline < TOP_BORDER_LINES || currentScanline >= TOP_BORDER_LINES + VISIBLE_LINES)
     {
@@ -446,29 +493,13 @@ void renderScanline()
 
         for (int charX = 0; charX < 32; charX++)
         {
-            uint8_t bmp = bmpPtr[charX];
-            uint8_t att = attPtr[charX];
-
-            int ink = att & 7;
-            int pap = (att >> 3) & 7;
-            bool br = (att & 0x40) != 0;
-
-            uint32_t fore = 0;
-            uint32_t back = 0;
-
-            if (((att & 0x80) == 0) || (_flash_act == 0)) {
-                fore = zx_colors[ink/*, br*/];
-                back = zx_colors[pap/*, br*/];
-            }
-            else {
-                fore = zx_colors[pap/*, br*/];
-                back = zx_colors[ink/*, br*/];
-            }
-
+            const uint32_t* colors = attr_colors[attPtr[charX]];
+            const uint32_t* mask = bitmap_mask[bmpPtr[charX]];
+            uint32_t diff = colors[0] ^ colors[1];
 
             int px = 32 + charX * 8;
-            for (int bit = 7; bit >= 0; bit--)
-                linePtr[px++] = (bmp & (1 << bit)) ? fore : back;
+            for (int bit = 0; bit < 8; bit++)
+                linePtr[px + bit] = colors[1] ^ (diff & mask[bit]);
         }
 
         for (int x = 32 + 256; x < 320; x++)
@@ -477,8 +508,21 @@ void renderScanline()
 
 }
 
+// Cada frame repinta todas las líneas, así que no importa que la memoria
+// bloqueada no conserve el frame anterior
+void lock_texture() {
+    void* tex_pixels;
+    if (SDL_LockTexture(texture, NULL, &tex_pixels, &frame_pitch) == 0)
+        frame_pixels = (uint8_t*)tex_pixels;
+    else
+        frame_pixels = NULL;
+}
+
 void update_texture() {
-    SDL_UpdateTexture(texture, NULL, pixels, FULL_WIDTH * sizeof(uint32_t));
+    if (frame_pixels != NULL) {
+        SDL_UnlockTexture(texture);
+        frame_pixels = NULL;
+    }
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, NULL, NULL);
     SDL_RenderPresent(renderer);
@@ -660,6 +704,7 @@ void zx_update(void) {
     if (_num_frames == 16) {   // FLASH ~ 1.56 Hz (50/32 ≈ 1.56)
         _num_frames = 0;
         _flash_act = !_flash_act;
+        build_attr_colors();
     }
 
     _num_frames++;
@@ -715,7 +760,7 @@ int main(int argc, char** argv) {
     SDL_RenderSetLogicalSize(renderer, FULL_WIDTH, FULL_HEIGHT);
 
     texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
-                                SDL_TEXTUREACCESS_STATIC, FULL_WIDTH, FULL_HEIGHT);
+                                SDL_TEXTUREACCESS_STREAMING, FULL_WIDTH, FULL_HEIGHT);
 
     init();
 	
@@ -746,6 +791,7 @@ int main(int argc, char** argv) {
     while (true) {
         handle_input();
 
+		lock_texture();
 		zx_update();
 
 		update_texture();
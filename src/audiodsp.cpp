@@ -0,0 +1,101 @@
+#include "audiodsp.h"
+#include <math.h>
+#include <string.h>
+
+// Corte del bloqueo de continua
+static const double DC_CUTOFF_HZ = 20.0;
+
+AudioDSPConfig speakerConfig(SpeakerModel model)
+{
+    switch (model)
+    {
+    case SPEAKER_48K:
+        return AudioDSPConfig{ true, 180, 4800, 256 };
+    case SPEAKER_TV:
+        return AudioDSPConfig{ true, 80, 8000, 256 };
+    default:
+        return AudioDSPConfig{ true, 0, 0, 256 };
+    }
+}
+
+void AudioDSP::init(uint32_t sampleRate)
+{
+    rate = sampleRate;
+    configure(speakerConfig(SPEAKER_LINE));
+    reset();
+}
+
+// Filtro de un polo: y += (x - y) * alpha, alpha = 1 - e^(-2·pi·fc/fs)
+int32_t AudioDSP::onePoleAlpha(uint32_t cutoffHz) const
+{
+    const double pi = 3.14159265358979323846;
+    double alpha = 1.0 - exp(-2.0 * pi * cutoffHz / rate);
+    return (int32_t)floor(alpha * (1 << COEF_BITS) + 0.5);
+}
+
+void AudioDSP::configure(const AudioDSPConfig& config)
+{
+    const double pi = 3.14159265358979323846;
+
+    this->config = config;
+    // y = x - x[-1] + R * y[-1], con R = 1 - 2·pi·fc/fs
+    dcPole = (int32_t)floor((1.0 - 2.0 * pi * DC_CUTOFF_HZ / rate) * (1 << COEF_BITS) + 0.5);
+    highPassAlpha = config.highPassHz ? onePoleAlpha(config.highPassHz) : 0;
+    lowPassAlpha = config.lowPassHz ? onePoleAlpha(config.lowPassHz) : 0;
+}
+
+void AudioDSP::setSampleRate(uint32_t sampleRate)
+{
+    rate = sampleRate;
+    configure(config);
+}
+
+void AudioDSP::reset()
+{
+    memset(state, 0, sizeof(state));
+}
+
+void AudioDSP::process(int16_t* samples, uint32_t count, int channels)
+{
+    bool dcBlock = config.dcBlock;
+    bool highPass = highPassAlpha != 0;
+    bool lowPass = lowPassAlpha != 0;
+    int32_t gain = config.gain;
+
+    for (int c = 0; c < channels; c++)
+    {
+        State s = state[c];
+        int16_t* p = samples + c;
+
+        for (uint32_t n = 0; n < count; n++, p += channels)
+        {
+            int32_t x = (int32_t)*p << STATE_BITS;
+
+            if (dcBlock)
+            {
+                int32_t y = x - s.dcIn + (int32_t)(((int64_t)s.dcOut * dcPole) >> COEF_BITS);
+                s.dcIn = x;
+                s.dcOut = y;
+                x = y;
+            }
+            if (highPass)
+            {
+                s.highPass += (int32_t)(((int64_t)(x - s.highPass) * highPassAlpha) >> COEF_BITS);
+                x -= s.highPass;
+            }
+            if (lowPass)
+            {
+                s.lowPass += (int32_t)(((int64_t)(x - s.lowPass) * lowPassAlpha) >> COEF_BITS);
+                x = s.lowPass;
+            }
+
+            int64_t y = ((int64_t)x * gain) >> 8;
+            y = (y + (1 << (STATE_BITS - 1))) >> STATE_BITS;
+            if (y > INT16_MAX) y = INT16_MAX;
+            if (y < INT16_MIN) y = INT16_MIN;
+            *p = (int16_t)y;
+        }
+
+        state[c] = s;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef _AUDIODSP_H_
+#define _AUDIODSP_H_
+
+#include <inttypes.h>
+
+// Postproceso del audio de cada frame, en el sitio y en coma fija. El
+// estado de los filtros se conserva entre frames, así que no hay saltos
+// en las fronteras.
+struct AudioDSPConfig
+{
+    bool dcBlock;           // quita la continua (el beeper y el AY solo dan valores positivos)
+    uint32_t highPassHz;    // 0 = sin filtro; un altavoz pequeño no da graves
+    uint32_t lowPassHz;     // 0 = sin filtro; ni agudos
+    int32_t gain;           // 256 = x1; lo que se pase de 16 bits se recorta
+};
+
+// Modelos de altavoz
+enum SpeakerModel
+{
+    SPEAKER_LINE,           // salida de línea: solo sin continua
+    SPEAKER_48K,            // el altavoz interno del 48K
+    SPEAKER_TV              // el altavoz de una tele (128K y posteriores)
+};
+
+AudioDSPConfig speakerConfig(SpeakerModel model);
+
+class AudioDSP
+{
+public:
+    void init(uint32_t sampleRate);
+    // Cambia los filtros sin perder el estado
+    void configure(const AudioDSPConfig& config);
+    // Recalcula los coeficientes para otra frecuencia de muestreo
+    void setSampleRate(uint32_t sampleRate);
+    void reset();
+
+    // 'count' muestras de 'channels' canales intercalados (1 o 2)
+    void process(int16_t* samples, uint32_t count, int channels);
+
+private:
+    uint32_t rate;
+    AudioDSPConfig config;
+
+    // Coeficientes en coma fija con COEF_BITS bits de fracción
+    static const int COEF_BITS = 15;
+    int32_t dcPole;
+    int32_t highPassAlpha;
+    int32_t lowPassAlpha;
+    int32_t onePoleAlpha(uint32_t cutoffHz) const;
+
+    // Estado de cada canal, con STATE_BITS bits de fracción por debajo de
+    // la muestra para que los filtros lentos no se queden atascados
+    static const int STATE_BITS = 8;
+    struct State
+    {
+        int32_t dcIn;
+        int32_t dcOut;
+        int32_t highPass;   // paso bajo cuyo complemento es el paso alto
+        int32_t lowPass;
+    };
+    State state[2];
+};
+
+#endif
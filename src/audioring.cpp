@@ -0,0 +1,101 @@
+#include "audioring.h"
+#include <string.h>
+
+AudioRing::AudioRing(uint32_t capacity, int channels)
+{
+    this->channels = channels;
+    uint32_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    buffer.assign(size, 0);
+    mask = size - 1;
+
+    head = 0;
+    tail = 0;
+    lastSample[0] = lastSample[1] = 0;
+    minFill = size;
+    maxFill = 0;
+    underruns = 0;
+    dropped = 0;
+}
+
+uint32_t AudioRing::push(const int16_t* src, uint32_t count)
+{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+
+    uint32_t space = capacity() - (h - t);
+    space -= space % channels;
+    if (count > space)
+    {
+        dropped.fetch_add(count - space, std::memory_order_relaxed);
+        count = space;
+    }
+
+    // Hasta dos trozos: hasta el final del buffer y desde el principio
+    uint32_t pos = h & mask;
+    uint32_t first = count < capacity() - pos ? count : capacity() - pos;
+    memcpy(&buffer[pos], src, first * sizeof(int16_t));
+    memcpy(&buffer[0], src + first, (count - first) * sizeof(int16_t));
+
+    head.store(h + count, std::memory_order_release);
+
+    uint32_t level = h + count - t;
+    if (level > maxFill.load(std::memory_order_relaxed))
+        maxFill.store(level, std::memory_order_relaxed);
+
+    return count;
+}
+
+void AudioRing::pull(int16_t* dst, uint32_t count)
+{
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+
+    uint32_t available = h - t;
+    if (available < minFill.load(std::memory_order_relaxed))
+        minFill.store(available, std::memory_order_relaxed);
+
+    uint32_t n = count < available ? count : available;
+    uint32_t pos = t & mask;
+    uint32_t first = n < capacity() - pos ? n : capacity() - pos;
+    memcpy(dst, &buffer[pos], first * sizeof(int16_t));
+    memcpy(dst + first, &buffer[0], (n - first) * sizeof(int16_t));
+
+    tail.store(t + n, std::memory_order_release);
+
+    for (uint32_t c = 0; c < (uint32_t)channels && c < n; c++)
+        lastSample[(n - 1 - c) % channels] = dst[n - 1 - c];
+
+    if (n < count)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+
+        // Caída exponencial (1/32 por muestra, unos 0,7 ms a 44,1 kHz)
+        // desde el último valor; si ya estaba en 0 es silencio sin más
+        for (uint32_t i = n; i < count; i++)
+        {
+            int32_t& last = lastSample[i % channels];
+            last -= (last + (last < 0 ? -31 : 31)) / 32;
+            dst[i] = (int16_t)last;
+        }
+    }
+}
+
+uint32_t AudioRing::fill() const
+{
+    // Primero 'tail': leído después, 'head' nunca puede quedar por detrás
+    uint32_t t = tail.load(std::memory_order_acquire);
+    return head.load(std::memory_order_acquire) - t;
+}
+
+AudioRing::Stats AudioRing::takeStats()
+{
+    Stats stats;
+    stats.fill = fill();
+    stats.minFill = minFill.exchange(capacity(), std::memory_order_relaxed);
+    stats.maxFill = maxFill.exchange(0, std::memory_order_relaxed);
+    stats.underruns = underruns.exchange(0, std::memory_order_relaxed);
+    stats.dropped = dropped.exchange(0, std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,68 @@
+#ifndef _AUDIORING_H_
+#define _AUDIORING_H_
+
+#include <inttypes.h>
+#include <atomic>
+#include <vector>
+
+// Cola circular de muestras entre el emulador (que escribe un frame de
+// golpe) y el callback de audio de SDL (que lee desde su propio hilo).
+// Un solo productor y un solo consumidor, sin locks: cada lado solo
+// modifica su índice. Toda la memoria se reserva en el constructor.
+class AudioRing
+{
+public:
+    // 'capacity' se redondea a la siguiente potencia de 2. Es la latencia
+    // máxima: lo que no cabe se descarta en vez de acumular retraso.
+    // Con 'channels' = 2 las muestras van en pares L/R intercalados y
+    // siempre se escriben y leen pares completos.
+    explicit AudioRing(uint32_t capacity, int channels = 1);
+
+    // Productor. Devuelve las muestras escritas; las que no caben se
+    // cuentan como descartadas.
+    uint32_t push(const int16_t* src, uint32_t count);
+
+    // Consumidor. Siempre llena 'count' muestras: si no hay bastantes,
+    // completa con la última muestra atenuándose hasta 0 (sin el
+    // chasquido de cortar a silencio de golpe) y cuenta un vacío.
+    void pull(int16_t* dst, uint32_t count);
+
+    // Muestras pendientes de leer. Desde cualquiera de los dos hilos es
+    // una foto que puede quedar vieja enseguida.
+    uint32_t fill() const;
+    uint32_t capacity() const { return mask + 1; }
+
+    // Telemetría, para mostrarla de vez en cuando
+    struct Stats
+    {
+        uint32_t fill;          // muestras pendientes ahora
+        uint32_t minFill;       // la menor vista por el consumidor
+        uint32_t maxFill;       // la mayor vista por el productor
+        uint32_t underruns;     // veces que el consumidor no tuvo bastante
+        uint32_t dropped;       // muestras descartadas por falta de sitio
+    };
+
+    // Devuelve los contadores y empieza un periodo nuevo
+    Stats takeStats();
+
+private:
+    std::vector<int16_t> buffer;
+    uint32_t mask;
+
+    // Posiciones absolutas (se comparan en módulo 2^32); cada una en su
+    // línea de caché para que los dos hilos no se la disputen
+    alignas(64) std::atomic<uint32_t> head;     // la escribe el productor
+    alignas(64) std::atomic<uint32_t> tail;     // la escribe el consumidor
+
+    int channels;
+
+    // Estado del consumidor: la última muestra de cada canal
+    int32_t lastSample[2];
+
+    std::atomic<uint32_t> minFill;
+    std::atomic<uint32_t> maxFill;
+    std::atomic<uint32_t> underruns;
+    std::atomic<uint32_t> dropped;
+};
+
+#endif
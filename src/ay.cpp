@@ -0,0 +1,426 @@
+#include "ay.h"
+#include "simd.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// Bits útiles de cada registro (los periodos altos son de 4 bits, etc.)
+static const uint8_t REG_MASK[16] = {
+    0xFF, 0x0F, 0xFF, 0x0F, 0xFF, 0x0F, 0x1F, 0xFF,
+    0x1F, 0x1F, 0x1F, 0xFF, 0xFF, 0x0F, 0xFF, 0xFF
+};
+
+// Curva del DAC (logarítmica), de 0 a 65535
+static const int32_t DAC_TABLE[16] = {
+    0, 655, 947, 1380, 2012, 2985, 4227, 7036,
+    8296, 13434, 19150, 24435, 32278, 41636, 52794, 65535
+};
+
+// Amplitud máxima de un canal: los tres juntos y el beeper caben en 16 bits
+static const int32_t CHANNEL_MAX = 6000;
+
+// Corte del filtro de diezmado, relativo a la frecuencia de salida
+static const double CUTOFF = 0.4;
+
+void AY::buildKernel()
+{
+    const double pi = 3.14159265358979323846;
+    double cutoff = CUTOFF * rate / tickRate;
+
+    kernel.resize(PHASES * TAPS);
+    for (int phase = 0; phase < PHASES; phase++)
+    {
+        // El tap n multiplica al tick que queda TAPS - 1 - n + fase por
+        // detrás de la muestra; el centro del sinc, TAPS / 2 ticks atrás
+        double taps[TAPS];
+        double sum = 0.0;
+        for (int n = 0; n < TAPS; n++)
+        {
+            double x = TAPS - 1 - n + (double)phase / PHASES - TAPS / 2;
+            double sinc = x == 0.0 ? 1.0 : sin(2.0 * pi * cutoff * x) / (2.0 * pi * cutoff * x);
+            double window = 0.42 + 0.5 * cos(2.0 * pi * x / TAPS) + 0.08 * cos(4.0 * pi * x / TAPS);
+            taps[n] = sinc * window;
+            sum += taps[n];
+        }
+
+        // Cada fase suma exactamente 1: un nivel constante sale sin error
+        int16_t* k = &kernel[phase * TAPS];
+        int32_t total = 0;
+        int peak = 0;
+        for (int n = 0; n < TAPS; n++)
+        {
+            k[n] = (int16_t)floor(taps[n] / sum * (1 << KERNEL_BITS) + 0.5);
+            total += k[n];
+            if (k[n] > k[peak])
+                peak = n;
+        }
+        k[peak] += (1 << KERNEL_BITS) - total;
+    }
+}
+
+void AY::init(uint32_t cpuClock, uint32_t sampleRate, uint32_t frameTstates)
+{
+    // El AY va a la mitad del reloj de la CPU y sus contadores a 1/8 de eso
+    tickRate = cpuClock / 16;
+    setOutputRate(sampleRate);
+
+    for (int v = 0; v < 16; v++)
+        dac[v] = DAC_TABLE[v] * CHANNEL_MAX / 65535;
+
+    uint32_t frameTicks = frameTstates / 16 + 1;
+    mix[0].assign(TAPS - 1 + frameTicks, 0);
+    mix[1].assign(TAPS - 1 + frameTicks, 0);
+    writes.reserve(1024);
+    stereo = AY_MONO;
+
+    reset();
+}
+
+void AY::reset()
+{
+    memset(regs, 0, sizeof(regs));
+    memset(synth, 0, sizeof(synth));
+    selected = 0;
+    writes.clear();
+
+    for (int c = 0; c < 3; c++)
+    {
+        toneCount[c] = 0;
+        toneOut[c] = 0;
+    }
+    noiseCount = 0;
+    noiseShift = 1;
+    noiseOut = 0;
+    resetEnvelope();
+
+    tickPhase = 0;
+    std::fill(mix[0].begin(), mix[0].end(), 0);
+    std::fill(mix[1].begin(), mix[1].end(), 0);
+    silentTicks = TAPS;
+    position = (uint64_t)(TAPS - 1) << 32;
+}
+
+void AY::setRate(uint32_t sampleRate)
+{
+    rate = sampleRate;
+    step = ((uint64_t)tickRate << 32) / rate;
+}
+
+void AY::setOutputRate(uint32_t sampleRate)
+{
+    rate = sampleRate;
+    buildKernel();
+    setRate(sampleRate);
+}
+
+void AY::writeRegister(uint32_t t, uint8_t value)
+{
+    if (selected >= 16)
+        return;
+
+    value &= REG_MASK[selected];
+    regs[selected] = value;
+    writes.push_back(Write{ t, selected, value });
+}
+
+void AY::apply(uint8_t reg, uint8_t value)
+{
+    synth[reg] = value;
+
+    // Escribir la forma reinicia la envolvente, aunque no cambie
+    if (reg == 13)
+        resetEnvelope();
+}
+
+void AY::resetEnvelope()
+{
+    uint8_t shape = synth[13];
+    envAttack = (shape & 0x04) ? 0x0F : 0x00;
+    if ((shape & 0x08) == 0)
+    {
+        // 0-7: una rampa y se queda a 0
+        envHold = true;
+        envAlternate = envAttack != 0;
+    }
+    else
+    {
+        envHold = (shape & 0x01) != 0;
+        envAlternate = (shape & 0x02) != 0;
+    }
+    envStep = 0x0F;
+    envHolding = false;
+    envVolume = envStep ^ envAttack;
+    envCount = 0;
+}
+
+bool AY::isSilent() const
+{
+    for (int c = 0; c < 3; c++)
+    {
+        uint8_t volume = synth[8 + c];
+        if (volume & 0x10)
+        {
+            if (!envHolding || envVolume != 0)
+                return false;
+        }
+        else if (volume != 0)
+            return false;
+    }
+    return true;
+}
+
+void AY::synthesize(uint32_t pos, uint32_t ticks)
+{
+    uint8_t mixer = synth[7];
+
+    // Periodos en ticks (0 cuenta como 1). Ruido y envolvente avanzan a la
+    // mitad de ritmo que los tonos.
+    uint32_t tonePeriod[3];
+    for (int c = 0; c < 3; c++)
+    {
+        tonePeriod[c] = synth[2 * c] | (synth[2 * c + 1] << 8);
+        if (tonePeriod[c] == 0) tonePeriod[c] = 1;
+    }
+    uint32_t noisePeriod = synth[6] ? 2 * synth[6] : 2;
+    uint32_t envPeriod = 2 * (synth[11] | (synth[12] << 8));
+    if (envPeriod == 0) envPeriod = 2;
+
+    while (ticks > 0)
+    {
+        // Nivel de cada canal en este tramo, y qué contadores pueden
+        // cambiarlo: los de un canal callado no se miran
+        int32_t amp[3];
+        bool toneUsed[3];
+        bool noiseUsed = false;
+        bool envUsed = false;
+        uint32_t run = ticks;
+
+        for (int c = 0; c < 3; c++)
+        {
+            uint8_t volume = synth[8 + c];
+            bool env = (volume & 0x10) != 0;
+            uint8_t level = env ? envVolume : volume;
+            bool toneOn = (mixer & (1 << c)) == 0;
+            bool noiseOn = (mixer & (8 << c)) == 0;
+
+            bool high = (toneOut[c] || !toneOn) && (noiseOut || !noiseOn);
+            amp[c] = high ? dac[level] : 0;
+
+            toneUsed[c] = false;
+            if (level == 0 && !env)
+                continue;
+            envUsed |= env;
+            noiseUsed |= noiseOn;
+            if (toneOn)
+            {
+                toneUsed[c] = true;
+                uint32_t left = toneCount[c] < tonePeriod[c] ? tonePeriod[c] - toneCount[c] : 1;
+                if (left < run) run = left;
+            }
+        }
+        if (noiseUsed)
+        {
+            uint32_t left = noiseCount < noisePeriod ? noisePeriod - noiseCount : 1;
+            if (left < run) run = left;
+        }
+        envUsed &= !envHolding;
+        if (envUsed)
+        {
+            uint32_t left = envCount < envPeriod ? envPeriod - envCount : 1;
+            if (left < run) run = left;
+        }
+
+        // El tramo, de una vez
+        int32_t left, right;
+        switch (stereo)
+        {
+        case AY_ABC:
+            left = amp[0] + amp[1] / 2;
+            right = amp[2] + amp[1] / 2;
+            break;
+        case AY_ACB:
+            left = amp[0] + amp[2] / 2;
+            right = amp[1] + amp[2] / 2;
+            break;
+        default:
+            left = right = amp[0] + amp[1] + amp[2];
+            break;
+        }
+        std::fill_n(&mix[0][pos], run, (int16_t)left);
+        if (stereo != AY_MONO)
+            std::fill_n(&mix[1][pos], run, (int16_t)right);
+        silentTicks = (left | right) == 0 ? silentTicks + run : 0;
+        pos += run;
+        ticks -= run;
+
+        // Avance de los contadores
+        for (int c = 0; c < 3; c++)
+        {
+            if (!toneUsed[c])
+                continue;
+            toneCount[c] += run;
+            if (toneCount[c] >= tonePeriod[c])
+            {
+                toneCount[c] = 0;
+                toneOut[c] ^= 1;
+            }
+        }
+
+        if (noiseUsed)
+        {
+            noiseCount += run;
+            if (noiseCount >= noisePeriod)
+            {
+                noiseCount = 0;
+                noiseShift = (noiseShift >> 1) | (((noiseShift ^ (noiseShift >> 3)) & 1) << 16);
+                noiseOut = noiseShift & 1;
+            }
+        }
+
+        if (envUsed)
+        {
+            envCount += run;
+            if (envCount >= envPeriod)
+            {
+                envCount = 0;
+                if (--envStep < 0)
+                {
+                    if (envAlternate)
+                        envAttack ^= 0x0F;
+                    if (envHold)
+                    {
+                        envHolding = true;
+                        envStep = 0;
+                    }
+                    else
+                        envStep = 0x0F;
+                }
+                envVolume = envStep ^ envAttack;
+            }
+        }
+    }
+}
+
+// Producto escalar de 'taps' muestras por los coeficientes de una fase
+static inline int32_t firScalar(const int16_t* x, const int16_t* k, int taps)
+{
+    int32_t sum = 0;
+    for (int n = 0; n < taps; n++)
+        sum += x[n] * k[n];
+    return sum;
+}
+
+#ifdef SIMD_SSE2
+// 8 productos por instrucción (PMADDWD), sumados de dos en dos a 32 bits
+static inline int32_t firSSE2(const int16_t* x, const int16_t* k, int taps)
+{
+    __m128i acc = _mm_setzero_si128();
+    for (int n = 0; n < taps; n += 8)
+    {
+        __m128i vx = _mm_loadu_si128((const __m128i*)(x + n));
+        __m128i vk = _mm_loadu_si128((const __m128i*)(k + n));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(vx, vk));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+    return _mm_cvtsi128_si32(acc);
+}
+#define FIR firSSE2
+#else
+#define FIR firScalar
+#endif
+
+static inline void addSample(int16_t& dst, int32_t value)
+{
+    value += dst;
+    if (value > INT16_MAX) value = INT16_MAX;
+    if (value < INT16_MIN) value = INT16_MIN;
+    dst = (int16_t)value;
+}
+
+void AY::endFrame(uint32_t frameTstates, int16_t* out, uint32_t count)
+{
+    // Las escrituras de este frame se colocan con la fase de su comienzo
+    uint32_t startPhase = tickPhase;
+    uint32_t frameTicks = (frameTstates + startPhase) / 16;
+    tickPhase = (frameTstates + startPhase) % 16;
+
+    size_t needed = TAPS - 1 + frameTicks;
+    if (mix[0].size() < needed)
+    {
+        mix[0].resize(needed, 0);
+        mix[1].resize(needed, 0);
+    }
+
+    // Sin escrituras, todo a 0 y el filtro ya vacío, no hay nada que sumar
+    // (un juego de 48K no paga nada por el AY)
+    if (writes.empty() && isSilent() && silentTicks >= TAPS)
+    {
+        position += count * step;
+        position -= (uint64_t)frameTicks << 32;
+        return;
+    }
+
+    // Síntesis, por tramos entre escrituras
+    uint32_t pos = 0;
+    size_t w = 0;
+    for (; w < writes.size() && writes[w].tstate < frameTstates; w++)
+    {
+        uint32_t tick = (writes[w].tstate + startPhase) / 16;
+        if (tick > frameTicks) tick = frameTicks;
+        if (tick > pos)
+        {
+            synthesize(TAPS - 1 + pos, tick - pos);
+            pos = tick;
+        }
+        apply(writes[w].reg, writes[w].value);
+    }
+    if (pos < frameTicks)
+        synthesize(TAPS - 1 + pos, frameTicks - pos);
+
+    // Las de después del final pasan al siguiente frame
+    size_t kept = 0;
+    for (; w < writes.size(); w++)
+    {
+        writes[kept] = writes[w];
+        writes[kept].tstate -= frameTstates;
+        kept++;
+    }
+    writes.resize(kept);
+
+    // Diezmado: cada muestra sale de los TAPS ticks que acaban en su posición
+    uint32_t first = TAPS - 1;
+    uint32_t last = TAPS - 1 + frameTicks - 1;
+    for (uint32_t n = 0; n < count; n++)
+    {
+        uint32_t index = (uint32_t)(position >> 32);
+        if (index < first) index = first;
+        if (index > last) index = last;
+        uint32_t phase = (uint32_t)(((position & 0xFFFFFFFF) * PHASES) >> 32);
+        const int16_t* k = &kernel[phase * TAPS];
+
+        const int16_t* l = &mix[0][index - (TAPS - 1)];
+        int32_t left = (FIR(l, k, TAPS) + (1 << (KERNEL_BITS - 1))) >> KERNEL_BITS;
+        if (stereo == AY_MONO)
+            addSample(out[n], left);
+        else
+        {
+            const int16_t* r = &mix[1][index - (TAPS - 1)];
+            int32_t right = (FIR(r, k, TAPS) + (1 << (KERNEL_BITS - 1))) >> KERNEL_BITS;
+            addSample(out[2 * n], left);
+            addSample(out[2 * n + 1], right);
+        }
+
+        position += step;
+    }
+    position -= (uint64_t)frameTicks << 32;
+
+    // Las últimas TAPS - 1 muestras quedan como historia del siguiente frame
+    memmove(mix[0].data(), mix[0].data() + frameTicks, (TAPS - 1) * sizeof(int16_t));
+    if (stereo != AY_MONO)
+        memmove(mix[1].data(), mix[1].data() + frameTicks, (TAPS - 1) * sizeof(int16_t));
+}
@@ -0,0 +1,99 @@
+#ifndef _AY_H_
+#define _AY_H_
+
+#include <inttypes.h>
+#include <vector>
+
+// AY-3-8912 en los puertos 0xFFFD (registro) y 0xBFFD (dato). Como en el
+// beeper, durante el frame solo se apuntan las escrituras con su T-estado.
+// Al final se genera la salida a la frecuencia interna del chip (reloj / 8,
+// un tick cada 16 T-estados) por tramos en los que no cambia nada, y se
+// diezma a la frecuencia de salida con un FIR polifásico.
+class AY
+{
+public:
+    // Reparto de los canales: todos al centro, o A-B-C / A-C-B de izquierda
+    // a derecha (el del medio, a media amplitud en los dos lados)
+    enum StereoMode { AY_MONO, AY_ABC, AY_ACB };
+
+    void init(uint32_t cpuClock, uint32_t sampleRate, uint32_t frameTstates);
+    void reset();
+
+    // Como Beeper::setRate
+    void setRate(uint32_t sampleRate);
+    // Nueva frecuencia base: rehace también el filtro de diezmado
+    void setOutputRate(uint32_t sampleRate);
+
+    void setStereo(StereoMode mode) { stereo = mode; }
+    StereoMode getStereo() const { return stereo; }
+    int channels() const { return stereo == AY_MONO ? 1 : 2; }
+
+    // 0xFFFD: la escritura selecciona el registro y la lectura lo devuelve
+    void selectRegister(uint8_t reg) { selected = reg; }
+    uint8_t readRegister() const { return selected < 16 ? regs[selected] : 0xFF; }
+    // 0xBFFD, desde el T-estado 't' del frame
+    void writeRegister(uint32_t t, uint8_t value);
+
+    // Cierra un frame de 'frameTstates' y suma sus 'count' muestras a las
+    // de 'out' (pares L/R intercalados si channels() == 2). Las escrituras
+    // de después del final suenan en el siguiente.
+    void endFrame(uint32_t frameTstates, int16_t* out, uint32_t count);
+
+private:
+    uint8_t regs[16];             // lo que ve la CPU
+    uint8_t selected;
+
+    struct Write
+    {
+        uint32_t tstate;
+        uint8_t reg;
+        uint8_t value;
+    };
+    std::vector<Write> writes;
+
+    // Estado de la síntesis, que va por detrás de 'regs' hasta endFrame()
+    uint8_t synth[16];
+    uint32_t toneCount[3];        // ticks desde el último cambio de la onda
+    uint8_t toneOut[3];
+    uint32_t noiseCount;
+    uint32_t noiseShift;          // LFSR de 17 bits
+    uint8_t noiseOut;
+    uint32_t envCount;
+    int envStep;
+    uint8_t envAttack;            // 0x0F si sube
+    bool envHold;
+    bool envAlternate;
+    bool envHolding;
+    uint8_t envVolume;
+
+    void apply(uint8_t reg, uint8_t value);
+    void resetEnvelope();
+    bool isSilent() const;
+    // Genera 'ticks' muestras a partir de mix[..][pos]
+    void synthesize(uint32_t pos, uint32_t ticks);
+
+    uint32_t tickPhase;           // T-estados de un tick empezado en el frame anterior
+    int32_t dac[16];              // amplitud de cada volumen
+
+    // Salida a la frecuencia del chip: las TAPS - 1 últimas muestras del
+    // frame anterior y después las de este (L y R, o solo mix[0] en mono)
+    std::vector<int16_t> mix[2];
+    uint32_t silentTicks;         // ticks seguidos a 0 al final de 'mix'
+
+    // Diezmado: PHASES posiciones entre ticks, TAPS ticks cada una, en
+    // coma fija con KERNEL_BITS bits de fracción
+    static const int PHASES = 64;
+    static const int TAPS = 128;
+    static const int KERNEL_BITS = 15;
+    std::vector<int16_t> kernel;  // PHASES * TAPS
+    void buildKernel();
+
+    uint32_t tickRate;
+    uint32_t rate;
+    uint64_t step;                // ticks por muestra de salida, en 32.32
+    uint64_t position;            // de la siguiente muestra dentro de 'mix', en 32.32
+
+    StereoMode stereo;
+};
+
+#endif
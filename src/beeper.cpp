@@ -0,0 +1,120 @@
+#include "beeper.h"
+#include <math.h>
+#include <string.h>
+
+// Amplitud de cada combinación EAR/MIC. EAR domina; MIC solo se oye un
+// poco. En reposo (los dos a 0) la salida es 0.
+static const int32_t AMPLITUDE[4] = { 0, 1000, 7000, 8000 };
+
+// Corte del filtro, relativo a la frecuencia de muestreo
+static const double CUTOFF = 0.45;
+
+int32_t Beeper::kernel[Beeper::PHASES][Beeper::TAPS];
+
+// Cada fase es la respuesta de un sinc con ventana de Blackman centrado en
+// TAPS / 2 + fase / PHASES; su suma es exactamente 1 para que el escalón
+// llegue a su nivel sin error
+void Beeper::buildKernel()
+{
+    const double pi = 3.14159265358979323846;
+
+    for (int phase = 0; phase < PHASES; phase++)
+    {
+        double taps[TAPS];
+        double sum = 0.0;
+        for (int n = 0; n < TAPS; n++)
+        {
+            double x = n - TAPS / 2 - (double)phase / PHASES;
+            double sinc = x == 0.0 ? 1.0 : sin(2.0 * pi * CUTOFF * x) / (2.0 * pi * CUTOFF * x);
+            double window = 0.42 + 0.5 * cos(2.0 * pi * x / TAPS) + 0.08 * cos(4.0 * pi * x / TAPS);
+            taps[n] = sinc * window;
+            sum += taps[n];
+        }
+
+        int32_t total = 0;
+        int peak = 0;
+        for (int n = 0; n < TAPS; n++)
+        {
+            kernel[phase][n] = (int32_t)floor(taps[n] / sum * (1 << KERNEL_BITS) + 0.5);
+            total += kernel[phase][n];
+            if (kernel[phase][n] > kernel[phase][peak])
+                peak = n;
+        }
+        kernel[phase][peak] += (1 << KERNEL_BITS) - total;
+    }
+}
+
+void Beeper::init(uint32_t clockHz, uint32_t sampleRate, uint32_t frameTstates)
+{
+    static bool kernelBuilt = false;
+    if (!kernelBuilt)
+    {
+        buildKernel();
+        kernelBuilt = true;
+    }
+
+    clock = clockHz;
+    rate = sampleRate;
+
+    // Un frame de muestras, más la cola de los escalones del final y los
+    // flancos de las instrucciones que se pasan del frame
+    uint32_t samplesPerFrame = (uint32_t)((uint64_t)frameTstates * rate / clock) + 1;
+    deltas.assign(samplesPerFrame + 2 * TAPS, 0);
+    edges.reserve(1024);
+
+    reset();
+}
+
+void Beeper::reset()
+{
+    edges.clear();
+    output = 0;
+    lastAmplitude = AMPLITUDE[0];
+    accumulator = lastAmplitude << KERNEL_BITS;
+    carry = 0;
+    memset(deltas.data(), 0, deltas.size() * sizeof(int32_t));
+}
+
+void Beeper::endFrame(uint32_t frameTstates, std::vector<int16_t>& out)
+{
+    // Posiciones en PHASES-avos de muestra: t * rate * PHASES / clock, más
+    // lo que sobró del frame anterior
+    uint64_t ticksPerTstate = (uint64_t)rate * PHASES;
+    uint64_t end = frameTstates * ticksPerTstate + carry;
+    uint32_t samples = (uint32_t)(end / clock / PHASES);
+
+    for (const Edge& edge : edges)
+    {
+        int32_t amplitude = AMPLITUDE[edge.level];
+        int32_t delta = amplitude - lastAmplitude;
+        lastAmplitude = amplitude;
+
+        uint64_t pos = (edge.tstate * ticksPerTstate + carry) / clock;
+        size_t index = (size_t)(pos / PHASES);
+        if (index + TAPS > deltas.size())
+            deltas.resize(index + TAPS, 0);
+
+        const int32_t* step = kernel[pos % PHASES];
+        int32_t* dst = &deltas[index];
+        for (int n = 0; n < TAPS; n++)
+            dst[n] += delta * step[n];
+    }
+    edges.clear();
+
+    // Integración: cada muestra es la suma de los escalones hasta ella
+    for (uint32_t n = 0; n < samples; n++)
+    {
+        accumulator += deltas[n];
+        int32_t sample = (accumulator + (1 << (KERNEL_BITS - 1))) >> KERNEL_BITS;
+        if (sample > INT16_MAX) sample = INT16_MAX;
+        if (sample < INT16_MIN) sample = INT16_MIN;
+        out.push_back((int16_t)sample);
+    }
+
+    // Lo que queda después del frame pasa al principio para el siguiente
+    size_t tail = deltas.size() - samples;
+    memmove(deltas.data(), deltas.data() + samples, tail * sizeof(int32_t));
+    memset(deltas.data() + tail, 0, samples * sizeof(int32_t));
+
+    carry = end - (uint64_t)samples * PHASES * clock;
+}
@@ -0,0 +1,62 @@
+#ifndef _BEEPER_H_
+#define _BEEPER_H_
+
+#include <inttypes.h>
+#include <vector>
+
+// Beeper del Spectrum: durante el frame solo se apuntan los flancos de la
+// salida de la ULA (bits EAR y MIC del puerto 0xFE) con su T-estado; al
+// final se sintetizan todas las muestras del frame de una pasada,
+// insertando cada escalón ya limitado en banda (BLEP) para que la señal de
+// 1 bit no genere aliasing.
+class Beeper
+{
+public:
+    void init(uint32_t clockHz, uint32_t sampleRate, uint32_t frameTstates);
+    void reset();
+
+    // Cambia la frecuencia de muestreo entre frames sin cortar la señal
+    // (para los pequeños ajustes del ritmo del audio)
+    void setRate(uint32_t sampleRate) { rate = sampleRate; }
+
+    // Salida EAR/MIC (bit 1 = EAR, bit 0 = MIC) desde el T-estado 't' del frame
+    void setOutput(uint32_t t, uint8_t earMic)
+    {
+        if (earMic != output)
+        {
+            output = earMic;
+            edges.push_back(Edge{ t, earMic });
+        }
+    }
+
+    // Cierra un frame de 'frameTstates' y añade sus muestras a 'out'.
+    // Los flancos de después del final (instrucciones que se pasan del
+    // frame) suenan en el siguiente.
+    void endFrame(uint32_t frameTstates, std::vector<int16_t>& out);
+
+private:
+    // Escalón limitado en banda: PHASES posiciones entre muestras, TAPS
+    // muestras cada una, en coma fija con KERNEL_BITS bits de fracción
+    static const int PHASES = 32;
+    static const int TAPS = 16;
+    static const int KERNEL_BITS = 15;
+    static int32_t kernel[PHASES][TAPS];
+    static void buildKernel();
+
+    struct Edge
+    {
+        uint32_t tstate;
+        uint8_t level;
+    };
+    std::vector<Edge> edges;
+    uint8_t output;               // nivel actual (el del último flanco)
+    int32_t lastAmplitude;        // amplitud ya insertada en 'deltas'
+
+    uint32_t clock;
+    uint32_t rate;
+    uint64_t carry;               // resto de muestra del frame anterior, en ticks
+    std::vector<int32_t> deltas;  // escalones pendientes de integrar
+    int32_t accumulator;
+};
+
+#endif
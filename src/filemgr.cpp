@@ -48,7 +48,7 @@ bool FileMgr::loadSNA(const char* filename, MinZX* targetEmulator)
 	}
 	fseek(pf, 0, SEEK_SET);
 
-	Z80* z80 = targetEmulator->getCPU();
+	MinZX::CPU* z80 = targetEmulator->getCPU();
 	uint8_t* mem = targetEmulator->getMemory();
 
 	targetEmulator->reset();
@@ -108,7 +108,7 @@ bool FileMgr::loadSNA(const char* filename, MinZX* targetEmulator)
 
 	z80->setRegSP(fgetWordLE(pf));
 
-	z80->setIM((Z80::IntMode)fgetc(pf));
+	z80->setIM((MinZX::CPU::IntMode)fgetc(pf));
 	targetEmulator->setBorderColor(fgetc(pf));
 
 	z80->setIFF1(z80->isIFF2());
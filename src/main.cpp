@@ -1,6 +1,8 @@
 ﻿#include <iostream>
 #include <iomanip>
 #include <vector>
+#include <cstring>
+#include <cstdlib>
 
 #pragma comment(lib, "SDL2.lib")
 #pragma comment(lib, "SDL2main.lib")
@@ -8,6 +10,9 @@
 #include "SDL.h"
 #include "minzx.h"
 #include "filemgr.h"
+#include "scaler.h"
+#include "audioring.h"
+#include "pacer.h"
 
 bool isLittleEndian()
 {
@@ -15,6 +20,13 @@ bool isLittleEndian()
     return *(uint8_t*)&val == 0x01;
 }
 
+// Hilo de audio de SDL: solo lee de la cola, nunca espera ni reserva memoria
+static void audioCallback(void* userdata, Uint8* stream, int len)
+{
+    AudioRing* ring = static_cast<AudioRing*>(userdata);
+    ring->pull(reinterpret_cast<int16_t*>(stream), len / sizeof(int16_t));
+}
+
 int main(int argc, char* argv[])
 {
     std::cout << (isLittleEndian() ? "Little endian" : "Big endian") << " machine\n";
@@ -22,51 +34,182 @@ int main(int argc, char* argv[])
     MinZX zx;
     zx.init();
 
+    // Opciones de pintado (el resto de argumentos es el snapshot):
+    //  --render-every N     pinta uno de cada N frames
+    //  --render-on-request  pinta solo al pulsar F11 o al redibujar la ventana
+    //  --no-render          no pinta ningún frame
+    // y de escalado:
+    //  --scale N            ventana a N x (1..3)
+    //  --epx                Scale2x/Scale3x en vez de vecino más próximo
+    //  --scanlines          oscurece una de cada N filas
+    // y de ritmo:
+    //  --vsync              lo marca el refresco de la pantalla, si va a
+    //                       ~50 Hz (si no, o sin aceleración, el audio)
+    // y de sonido:
+    //  --ay-stereo abc|acb  AY en estéreo (por defecto, mono)
+    //  --speaker 48k|tv     filtra el audio como el altavoz del 48K o el de
+    //                       una tele (por defecto, salida de línea)
+    const char* snaFile = nullptr;
+    ScalerConfig scaler = { 1, SCALE_NEAREST, false };
+    bool vsync = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--render-every") == 0 && i + 1 < argc)
+            zx.setRenderMode(MinZX::RENDER_EVERY_NTH, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--render-on-request") == 0)
+            zx.setRenderMode(MinZX::RENDER_ON_REQUEST);
+        else if (strcmp(argv[i], "--no-render") == 0)
+            zx.setRenderMode(MinZX::RENDER_NONE);
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+            scaler.factor = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--epx") == 0)
+            scaler.filter = SCALE_EPX;
+        else if (strcmp(argv[i], "--scanlines") == 0)
+            scaler.scanlines = true;
+        else if (strcmp(argv[i], "--vsync") == 0)
+            vsync = true;
+        else if (strcmp(argv[i], "--ay-stereo") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "abc") == 0)
+                zx.setAYStereo(AY::AY_ABC);
+            else if (strcmp(argv[i], "acb") == 0)
+                zx.setAYStereo(AY::AY_ACB);
+        }
+        else if (strcmp(argv[i], "--speaker") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "48k") == 0)
+                zx.setAudioDSP(speakerConfig(SPEAKER_48K));
+            else if (strcmp(argv[i], "tv") == 0)
+                zx.setAudioDSP(speakerConfig(SPEAKER_TV));
+        }
+        else
+            snaFile = argv[i];
+    }
+
     FileMgr fm;
-    if (argc > 1) fm.loadSNA(argv[1], &zx);
+    if (snaFile != nullptr) fm.loadSNA(snaFile, &zx);
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
         std::cerr << "SDL_Init error: " << SDL_GetError() << "\n";
         return 1;
     }
 
+    if (scaler.factor < 1) scaler.factor = 1;
+    if (scaler.factor > 3) scaler.factor = 3;
+
+    const int FRAME_W = 320;
+    const int FRAME_H = 240;
+    const int TEX_W = FRAME_W * scaler.factor;
+    const int TEX_H = FRAME_H * scaler.factor;
+
     SDL_Window* window = SDL_CreateWindow("MinZX SDL", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        320, 240, SDL_WINDOW_SHOWN);
+        TEX_W, TEX_H, SDL_WINDOW_SHOWN);
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Con vsync la pantalla tiene que ir casi al ritmo del Spectrum: el
+    // audio solo se puede corregir un 0,5%
+    if (vsync)
+    {
+        SDL_DisplayMode mode;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) != 0 ||
+            mode.refresh_rate < zx.getFrameRate() - 1 || mode.refresh_rate > zx.getFrameRate() + 1)
+        {
+            std::cerr << "Display is not at 50 Hz, pacing from the audio clock instead of vsync.\n";
+            vsync = false;
+        }
+    }
+
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1,
+        SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+
+    // Sin aceleración se pinta directamente en la superficie de la ventana,
+    // que tiene el tamaño de la salida y conserva el frame anterior. Si su
+    // formato no es de 32 bits xRGB se usa el renderer software.
+    SDL_Surface* surface = nullptr;
+    if (renderer == nullptr)
+    {
+        vsync = false;
+        surface = SDL_GetWindowSurface(window);
+        if (surface == nullptr || surface->w != TEX_W || surface->h != TEX_H ||
+            (surface->format->format != SDL_PIXELFORMAT_ARGB8888 &&
+             surface->format->format != SDL_PIXELFORMAT_RGB888))
+        {
+            surface = nullptr;
+            renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+        }
+    }
+
+    // Cola entre el emulador y el callback de audio: 4096 muestras por
+    // canal (unos 93 ms) como máximo; no se empieza a sonar hasta tener
+    // AUDIO_PREFILL, que es también el nivel que intenta mantener el ritmo
+    // de los frames
+    const int audioChannels = zx.getAudioChannels();
+    const uint32_t AUDIO_PREFILL = 2048;
+    AudioRing audioRing(4096 * audioChannels, audioChannels);
+    bool audioStarted = false;
 
     SDL_AudioSpec want, have;
     SDL_zero(want);
-    want.freq = 44100;
+    want.freq = MinZX::getAudioSampleRate();
     want.format = AUDIO_S16SYS;
-    want.channels = 1;
+    want.channels = audioChannels;
     want.samples = 1024;
-    want.callback = nullptr;
+    want.callback = audioCallback;
+    want.userdata = &audioRing;
 
-    // Request the exact format (do not allow SDL to change it automatically).
-    SDL_AudioDeviceID audio_dev = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    // Formato exacto, pero la frecuencia la elige el dispositivo: si es
+    // otra, el beeper, el AY y el DSP sintetizan directamente a ella
+    SDL_AudioDeviceID audio_dev = SDL_OpenAudioDevice(NULL, 0, &want, &have,
+        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    uint32_t audioRate = MinZX::getAudioSampleRate();
 
     if (audio_dev == 0) {
         std::cerr << "Audio error: " << SDL_GetError() << "\n";
     } else {
-        if (have.format != want.format || have.channels != want.channels || have.freq != want.freq) {
+        if (have.freq != want.freq) {
+            audioRate = have.freq;
+            zx.setAudioOutputRate(audioRate);
+        }
+        if (have.format != want.format || have.channels != want.channels) {
             std::cerr << "Warning: audio device opened with different format than requested.\n";
             std::cerr << "Requested: freq=" << want.freq << " fmt=" << want.format << " ch=" << (int)want.channels << "\n";
             std::cerr << "Got:       freq=" << have.freq << " fmt=" << have.format << " ch=" << (int)have.channels << "\n";
-            // We requested exact format (flags=0). If device still differs, you must convert samples before queuing.
-            // For now, if formats differ we will still try to queue int16 samples, but best is to reopen device with a supported format or convert.
+            // No se permiten cambios de formato ni de canales: SDL convierte al del dispositivo
         }
-
-        // Start the audio device
-        SDL_PauseAudioDevice(audio_dev, 0);
     }
 
-    const int TEX_W = 320;
-    const int TEX_H = 240;
-    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING, TEX_W, TEX_H);
+    SDL_Texture* texture = nullptr;
+    if (renderer != nullptr)
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STREAMING, TEX_W, TEX_H);
 
-    std::vector<uint8_t> pixels(TEX_W * TEX_H * 4, 0);
+    // Escalando, el emulador pinta a 1x en su propio buffer (que conserva
+    // el frame anterior) y el escalador escribe en la textura o la ventana
+    std::vector<uint8_t> frame;
+    if (scaler.factor > 1)
+        frame.resize(FRAME_W * FRAME_H * 4);
+
+    // Sin escalar se pinta directamente en la memoria de SDL_LockTexture.
+    // SDL no promete que conserve el frame anterior, pero estos renderers
+    // devuelven siempre su copia de la textura en memoria del sistema; con
+    // los demás hay que repintar todas las líneas en cada frame.
+    bool texKeepsPixels = false;
+    SDL_RendererInfo rendererInfo;
+    if (texture != nullptr && SDL_GetRendererInfo(renderer, &rendererInfo) == 0)
+    {
+        static const char* const keepers[] = { "software", "opengl", "opengles2", "direct3d" };
+        for (const char* name : keepers)
+            if (strcmp(rendererInfo.name, name) == 0)
+                texKeepsPixels = true;
+    }
+
+    FramePacer pacer;
+    FramePacer::Mode paceMode = FramePacer::PACE_TIMER;
+    if (audio_dev != 0)
+        paceMode = vsync ? FramePacer::PACE_VSYNC : FramePacer::PACE_AUDIO;
+    pacer.init(paceMode, zx.getFrameRate(), audioRate, AUDIO_PREFILL);
+    const double perfFreq = (double)SDL_GetPerformanceFrequency();
 
     bool running = true;
     SDL_Event ev;
@@ -84,6 +227,14 @@ int main(int argc, char* argv[])
             if (ev.type == SDL_KEYDOWN && ev.key.keysym.scancode == SDL_SCANCODE_F12)
                 zx.reset();
 
+            // Al perder el dispositivo se pierde también el contenido de la textura
+            if (ev.type == SDL_RENDER_TARGETS_RESET || ev.type == SDL_RENDER_DEVICE_RESET)
+                zx.invalidateScreen();
+
+            if ((ev.type == SDL_KEYDOWN && ev.key.keysym.scancode == SDL_SCANCODE_F11) ||
+                (ev.type == SDL_WINDOWEVENT && ev.window.event == SDL_WINDOWEVENT_EXPOSED))
+                zx.requestFrame();
+
             if (ev.type == SDL_KEYDOWN || ev.type == SDL_KEYUP)
             {
                 bool press = (ev.type == SDL_KEYDOWN);
@@ -142,23 +293,91 @@ int main(int argc, char* argv[])
             }
         }
 
-        zx.update(pixels.data());
+        // Sin escalar, el frame se pinta directamente en la memoria de
+        // vídeo, sin buffer intermedio ni copia
+        if (scaler.factor > 1)
+            zx.update(frame.data());
+        else if (surface != nullptr)
+        {
+            if (SDL_MUSTLOCK(surface))
+                SDL_LockSurface(surface);
+            zx.update((uint8_t*)surface->pixels, surface->pitch);
+            if (SDL_MUSTLOCK(surface))
+                SDL_UnlockSurface(surface);
+        }
+        else
+        {
+            // Se bloquea la textura entera (update() solo escribe las líneas
+            // sucias) y solo si el frame se va a pintar
+            void* texPixels;
+            int texPitch;
+            if (zx.willRender() && SDL_LockTexture(texture, nullptr, &texPixels, &texPitch) == 0)
+            {
+                if (!texKeepsPixels)
+                    zx.invalidateScreen();
+                zx.update((uint8_t*)texPixels, texPitch);
+                SDL_UnlockTexture(texture);
+            }
+            else
+                zx.update(nullptr);
+        }
 
         const auto& abuf = zx.getAudioBuffer();
         if (!abuf.empty() && audio_dev != 0)
         {
-            // Queue int16 samples (device was requested with AUDIO_S16SYS).
-            SDL_QueueAudio(audio_dev, abuf.data(), static_cast<uint32_t>(abuf.size() * sizeof(int16_t)));
-            zx.clearAudioBuffer();
+            audioRing.push(abuf.data(), static_cast<uint32_t>(abuf.size()));
+            if (!audioStarted && audioRing.fill() >= AUDIO_PREFILL * audioChannels)
+            {
+                SDL_PauseAudioDevice(audio_dev, 0);
+                audioStarted = true;
+            }
         }
+        zx.clearAudioBuffer();
 
-        SDL_UpdateTexture(texture, nullptr, pixels.data(), TEX_W * 4);
+        // Solo se presentan los frames pintados y, en la superficie de la
+        // ventana, solo las líneas que update() ha repintado. Con vsync se
+        // presentan todos: el present es lo que marca el ritmo.
+        int firstLine, lastLine;
+        bool updated = zx.getUpdatedLines(firstLine, lastLine);
+        if (updated || paceMode == FramePacer::PACE_VSYNC)
+        {
+            if (surface != nullptr)
+            {
+                if (scaler.factor > 1)
+                {
+                    scaleRowsAffected(scaler, FRAME_H, firstLine, lastLine);
+                    if (SDL_MUSTLOCK(surface))
+                        SDL_LockSurface(surface);
+                    scaleFrame((uint8_t*)surface->pixels, surface->pitch, frame.data(), FRAME_W * 4,
+                        FRAME_W, FRAME_H, firstLine, lastLine + 1, scaler);
+                    if (SDL_MUSTLOCK(surface))
+                        SDL_UnlockSurface(surface);
+                }
 
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-        SDL_RenderPresent(renderer);
+                SDL_Rect rect = { 0, firstLine * scaler.factor, TEX_W, (lastLine - firstLine + 1) * scaler.factor };
+                SDL_UpdateWindowSurfaceRects(window, &rect, 1);
+            }
+            else
+            {
+                void* texPixels;
+                int texPitch;
+                if (updated && scaler.factor > 1 && SDL_LockTexture(texture, nullptr, &texPixels, &texPitch) == 0)
+                {
+                    scaleFrame((uint8_t*)texPixels, texPitch, frame.data(), FRAME_W * 4,
+                        FRAME_W, FRAME_H, 0, FRAME_H, scaler);
+                    SDL_UnlockTexture(texture);
+                }
+
+                SDL_RenderClear(renderer);
+                SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+                SDL_RenderPresent(renderer);
+            }
+        }
 
-        SDL_Delay(20);
+        double wait = pacer.frameDone(SDL_GetPerformanceCounter() / perfFreq, audioRing.fill() / audioChannels);
+        zx.setAudioSampleRate(pacer.sampleRate());
+        if (wait > 0.0)
+            SDL_Delay((uint32_t)(wait * 1000));
 
         frames++;
         uint64_t now = SDL_GetPerformanceCounter();
@@ -166,6 +385,15 @@ int main(int argc, char* argv[])
         if (sec > 2.0)
         {
             printf("%.1f FPS   %.1f ms/frame\n", frames / sec, sec * 1000 / frames);
+            FramePacer::Report pr = pacer.takeReport(now / perfFreq);
+            printf("pace: %.3f Hz (%+.0f ppm)   latency %.1f ms   adjust %+.0f ppm\n",
+                pr.frameRate, pr.driftPpm, pr.latencyMs, pr.adjustPpm);
+            if (audioStarted)
+            {
+                AudioRing::Stats as = audioRing.takeStats();
+                printf("audio: %u/%u samples (min %u, max %u)   %u underruns   %u dropped\n",
+                    as.fill, audioRing.capacity(), as.minFill, as.maxFill, as.underruns, as.dropped);
+            }
             start = now;
             frames = 0;
         }
@@ -175,8 +403,10 @@ int main(int argc, char* argv[])
     if (audio_dev != 0)
         SDL_CloseAudioDevice(audio_dev);
 
-    SDL_DestroyTexture(texture);
-    SDL_DestroyRenderer(renderer);
+    if (texture != nullptr)
+        SDL_DestroyTexture(texture);
+    if (renderer != nullptr)
+        SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
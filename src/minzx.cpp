@@ -1,9 +1,11 @@
 ﻿#include "minzx.h"
 #include "z80.h"
+#include "z80_impl.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <vector>
+#include <algorithm>
 
 #include "tape/tape_stream.h"
 #include "tape/tap_loader.h"
@@ -17,11 +19,15 @@
 #define ERROR   printf
 #define FATAL   printf
 
+// Instancia del núcleo Z80 con el bus de MinZX resuelto en compilación
+template class Z80Core<MinZX>;
+
 #define VAL_BRIGHT    255
 #define VAL_NO_BRIGHT 176
 
 uint32_t speColors[16];
 
+
 static void createSpectrumColors()
 {
     uint32_t A = 0xFF000000;
@@ -57,37 +63,160 @@ uint32_t MinZX::zxColor(int c, bool bright)
     return speColors[c];
 }
 
-const double CLOCK_FREQ = 3500000.0;
-const int    AUDIO_SAMPLE_RATE = 44100;
-const double TSTATES_PER_SAMPLE = CLOCK_FREQ / AUDIO_SAMPLE_RATE;
-const int16_t HIGH_LEVEL = 8000;
-const int16_t LOW_LEVEL = -8000;
-const double FILTER_ALPHA = 0.5;
+const MachineTiming MinZX::TIMING_48K  = { 69888, 224, 14335 };
+
+// Margen tras el fin de frame: la última instrucción (y la aceptación de la
+// INT) puede terminar unos T-estados después de cycleTstates
+static const uint32_t CONTENTION_TABLE_SLACK = 256;
+
+void MinZX::buildContentionTable(const MachineTiming& timing)
+{
+    static const uint8_t wait_states[8] = { 6,5,4,3,2,1,0,0 };
+
+    uint32_t size = timing.frameTstates + CONTENTION_TABLE_SLACK;
+    delete[] contentionTable;
+    contentionTable = new uint8_t[size];
+    memset(contentionTable, 0, size);
+
+    for (uint32_t line = 0; line < VISIBLE_LINES; line++)
+    {
+        uint32_t base = timing.firstContended + line * timing.tstatesPerLine;
+        for (uint32_t t = 0; t < TSTATES_ACTIVE_FETCH; t++)
+            contentionTable[base + t] = wait_states[t % 8];
+    }
+
+    // 48K: solo 0x4000-0x7FFF
+    contendedPage[0] = false;
+    contendedPage[1] = true;
+    contendedPage[2] = false;
+    contendedPage[3] = false;
+}
+
+// Bus flotante: en cada bloque de 8 T-estados de la zona activa la ULA lee
+// bitmap, atributo, bitmap y atributo de dos celdas y descansa 4. La
+// primera lectura de cada línea es un T-estado después del primero
+// contenido.
+void MinZX::buildFloatingBusTable(const MachineTiming& timing)
+{
+    uint32_t size = timing.frameTstates + CONTENTION_TABLE_SLACK;
+    delete[] floatingBusTable;
+    floatingBusTable = new uint16_t[size];
+    memset(floatingBusTable, 0, size * sizeof(uint16_t));
+
+    for (uint32_t line = 0; line < VISIBLE_LINES; line++)
+    {
+        uint32_t base = timing.firstContended + 1 + line * timing.tstatesPerLine;
+        uint32_t ulaY = (line & 0xC0) | ((line & 0x38) >> 3) | ((line & 0x07) << 3);
+        uint16_t bitmap = 0x4000 + (ulaY << 5);
+        uint16_t attr = 0x5800 + ((line >> 3) << 5);
+
+        for (uint32_t slot = 0; slot < TSTATES_ACTIVE_FETCH / 8; slot++)
+        {
+            uint32_t t = base + slot * 8;
+            uint16_t charX = slot * 2;
+            floatingBusTable[t + 0] = bitmap + charX;
+            floatingBusTable[t + 1] = attr + charX;
+            floatingBusTable[t + 2] = bitmap + charX + 1;
+            floatingBusTable[t + 3] = attr + charX + 1;
+        }
+    }
+}
+
+// Ningún byte de [start, start + step * (count - 1)] cae en página
+// contenida (ni el rango da la vuelta a 0xFFFF)
+bool MinZX::isUncontendedRange(uint16_t start, uint16_t count, int step)
+{
+    int32_t lo = step > 0 ? start : start - (count - 1);
+    int32_t hi = step > 0 ? start + (count - 1) : start;
+    if (lo < 0 || hi > 0xFFFF)
+        return false;
+
+    for (int page = lo >> 14; page <= (hi >> 14); page++)
+        if (contendedPage[page])
+            return false;
+    return true;
+}
+
+const uint32_t CLOCK_FREQ = 3500000;
+const uint32_t AUDIO_SAMPLE_RATE = 44100;
+
+uint32_t MinZX::getAudioSampleRate()
+{
+    return AUDIO_SAMPLE_RATE;
+}
+
+void MinZX::setAudioOutputRate(uint32_t hz)
+{
+    // El buffer del beeper, el filtro de diezmado del AY y los coeficientes
+    // de los filtros dependen de la frecuencia
+    beeper.init(CLOCK_FREQ, hz, cycleTstates);
+    ay.setOutputRate(hz);
+    dsp.setSampleRate(hz);
+    audioBuffer.clear();
+    audioBuffer.reserve(2 * hz / 25);
+}
+
+double MinZX::getFrameRate() const
+{
+    return (double)CLOCK_FREQ / cycleTstates;
+}
 
 void MinZX::init()
 {
-    z80 = new Z80(this);
+    z80 = new CPU(this);
     mem = new uint8_t[0x10000];
     ports = new uint8_t[0x10000];
+    contentionTable = nullptr;
+    floatingBusTable = nullptr;
 
     memset(mem, 0x00, 0x10000);
     memset(ports, 0xFF, 0x10000);
     memset(keymatrix, 0xFF, sizeof(keymatrix));
 
-    cycleTstates = 69888;
+    cycleTstates = TIMING_48K.frameTstates;
+    buildContentionTable(TIMING_48K);
+    buildFloatingBusTable(TIMING_48K);
     loadROM();
 
     createSpectrumColors();
+    screenRow = selectScreenRowKernel();
+    screenPtr = nullptr;
+    screenPitch = 0;
+    frameFormat = FRAME_ARGB8888;
+    outputPtr = nullptr;
+    outputPitch = 0;
+    renderMode = RENDER_ALWAYS;
+    renderInterval = 1;
+    renderCountdown = 0;
+    renderRequested = false;
+    indexToRGB565 = selectIndexToRGB565();
+    for (int c = 0; c < 16; c++)
+        rgb565Palette[c] = toRGB565(speColors[c]);
+    updatedFirst = DISPLAY_LINES;
+    updatedLast = -1;
+    beamLine = 0;
+    beamX = 0;
+    beamLineDraw = false;
+    borderLog.reserve(1024);
+    borderLog.assign(1, BorderEvent{ 0, border });
+    borderCursor = 0;
+    flashFrames = 0;
+    flashActive = false;
+    buildAttrTable(attrTable, speColors, flashActive);
+    buildAttrIndexTable(attrIndexTable, flashActive);
 
     intPending = false;
-    speakerLevel = false;
-    lastTstate = 0;
-    fractional = 0.0;
+    beeper.init(CLOCK_FREQ, AUDIO_SAMPLE_RATE, cycleTstates);
+    ay.init(CLOCK_FREQ, AUDIO_SAMPLE_RATE, cycleTstates);
+    dsp.init(AUDIO_SAMPLE_RATE);
+    audioBuffer.reserve(2 * AUDIO_SAMPLE_RATE / 25);
     currentScanline = 0;
     tstatesThisLine = 0;
-    ulaFetchPhase = -1;
-    isInVisibleArea = false;
-    currentVideoAddress = 0;
+    idleWrites = 0;
+    contendedAccesses = 0;
+    probing = false;
+    volatileIO = 0;
+    idleBackoff = 0;
 
     // Inicializa el reproductor de cinta a nullptr (se puede asignar con FileMgr)
     //tapePlayer = nullptr;
@@ -96,16 +225,6 @@ void MinZX::init()
     reset();
 }
 
-// Incrementa tstates y notifica al TzxPlayer si está reproduciendo
-void MinZX::addTstates(uint32_t delta)
-{
-    if (delta == 0) return;
-    tstates += delta;
-    /*if (tapePlayer && tapePlaying) {
-        tapePlayer->advanceByTstates(delta);
-    }*/
-}
-
 void MinZX::reset()
 {
     border = 7;
@@ -117,16 +236,14 @@ void MinZX::reset()
     memset(keymatrix, 0xFF, sizeof(keymatrix));
     intPending = false;
 
-    speakerLevel = false;
-    lastTstate = 0;
-    fractional = 0.0;
+    beeper.reset();
+    ay.reset();
+    dsp.reset();
     audioBuffer.clear();
 
     currentScanline = 0;
     tstatesThisLine = 0;
-    ulaFetchPhase = -1;
-    isInVisibleArea = false;
-    currentVideoAddress = 0;
+    invalidateScreen();
 
     //if (tapePlayer) tapePlayer->rewind();
     tapePlaying = false;
@@ -180,48 +297,108 @@ inline bool Tape_GetEAR() {
 }
 
 
-int _num_frames = 0;
-bool _flash_act = false;
-
-void MinZX::update(uint8_t* screen)
+void MinZX::update(uint8_t* screen, int pitch)
 {
-    screenPtr = screen;
+    bool draw = willRender();
+    if (renderMode == RENDER_EVERY_NTH)
+        renderCountdown = draw ? renderInterval - 1 : renderCountdown - 1;
+    renderRequested = false;
+
+    if (draw)
+    {
+        if (pitch == 0)
+            pitch = DISPLAY_WIDTH * (frameFormat == FRAME_ARGB8888 ? 4 : frameFormat == FRAME_RGB565 ? 2 : 1);
+        if (screen != outputPtr || pitch != outputPitch)
+            invalidateScreen();
+        outputPtr = screen;
+        outputPitch = pitch;
+    }
+    else
+        screen = nullptr;   // sin pintar: el haz no avanza y las líneas siguen sucias
+
+    // En RGB565 se pinta en índices y se convierte al final del frame
+    if (frameFormat == FRAME_RGB565 && screen != nullptr)
+    {
+        screenPtr = indexFrame.data();
+        screenPitch = DISPLAY_WIDTH;
+    }
+    else
+    {
+        screenPtr = screen;
+        screenPitch = pitch;
+    }
+    updatedFirst = DISPLAY_LINES;
+    updatedLast = -1;
+    beamLine = 0;
+    beamX = 0;
+    borderLog.assign(1, BorderEvent{ 0, border });
+    borderCursor = 0;
 
     tstates = 0;
     currentScanline = 0;
     tstatesThisLine = 0;
-    ulaFetchPhase = -1;
-    isInVisibleArea = false;
-    currentVideoAddress = 0;
-
-    lastTstate = 0;
 
     while (tstates < cycleTstates)
     {
-        z80->execute();
-        //tape.advance(10);
-
+        // El siguiente evento es el fin de la scanline en curso: la CPU corre
+        // sin interrupciones hasta él (312 * 224 == cycleTstates)
+        uint32_t nextEvent = (currentScanline + 1) * TSTATES_PER_SCANLINE;
+        if (nextEvent > cycleTstates)
+            nextEvent = cycleTstates;
+        // HALT y bucles ociosos no tocan la memoria ni el borde: se pueden
+        // saltar hasta la INT y pintar después las scanlines pendientes
+        skipIdleLoop(nextEvent, cycleTstates);
+        z80->executeUntil(nextEvent);
+        if (z80->isHalted())
+            skipHalt(cycleTstates);
+
+        // Una instrucción larga puede cruzar más de una scanline
         while (tstates >= (currentScanline + 1) * TSTATES_PER_SCANLINE)
         {
-            renderScanline();
             currentScanline++;
 
             tape.advance(224);
-            //flushAudioBuffer(224);
-            //applyLowPassFilter();
         }
     }
 
-    if (_num_frames == 16) {   // FLASH ~ 1.56 Hz (50/32 ≈ 1.56)
-        _num_frames = 0;
-        _flash_act = !_flash_act;
+    // Lo que queda del frame desde la última escritura en pantalla
+    renderUpTo(cycleTstates);
+
+    // Una sola pasada de paleta, solo sobre las líneas repintadas
+    if (frameFormat == FRAME_RGB565 && screenPtr != nullptr)
+    {
+        for (int line = updatedFirst; line <= updatedLast; line++)
+            indexToRGB565((uint16_t*)(outputPtr + line * outputPitch),
+                          &indexFrame[line * DISPLAY_WIDTH], DISPLAY_WIDTH, rgb565Palette);
+    }
+
+    if (flashFrames == 16) {   // FLASH ~ 1.56 Hz (50/32 ≈ 1.56)
+        flashFrames = 0;
+        flashActive = !flashActive;
+        buildAttrTable(attrTable, speColors, flashActive);
+        buildAttrIndexTable(attrIndexTable, flashActive);
+        markFlashDirty();
     }
 
-    _num_frames++;
+    flashFrames++;
+
+    // Las muestras del frame salen de una vez de los flancos registrados
+    // y de las escrituras en el AY, que se suma encima
+    size_t audioStart = audioBuffer.size();
+    beeper.endFrame(cycleTstates, audioBuffer);
+    uint32_t samples = (uint32_t)(audioBuffer.size() - audioStart);
+    if (ay.channels() == 2)
+    {
+        // El beeper suena igual en los dos lados
+        audioBuffer.resize(audioStart + 2 * samples);
+        int16_t* frame = audioBuffer.data() + audioStart;
+        for (uint32_t n = samples; n-- > 0; )
+            frame[2 * n] = frame[2 * n + 1] = frame[n];
+    }
+    ay.endFrame(cycleTstates, audioBuffer.data() + audioStart, samples);
+    dsp.process(audioBuffer.data() + audioStart, samples, ay.channels());
 
-    //flushAudioBuffer(cycleTstates);
     //tape.advance(6998);
-    applyLowPassFilter();
 
     //tape.advance(tstates);
 
@@ -237,154 +414,379 @@ void MinZX::update(uint8_t* screen)
     tstates -= cycleTstates;
 }
 
-void MinZX::renderScanline()
+// CPU en HALT: si no puede entrar una INT antes de 'limit' (la señal sólo
+// cambia entre frames), los refrescos del HALT se contabilizan de golpe
+void MinZX::skipHalt(uint32_t limit)
 {
-    if (currentScanline < 0 || currentScanline >= TOTAL_SCANLINES)
-        return;
-
-    uint32_t borderColor = zxColor(border, false);
-
-    int displayY = currentScanline - (TOP_BORDER_LINES - 24);
-    if (displayY < 0 || displayY >= 240)
+    if (tstates >= limit || (intPending && z80->isIFF1()) || z80->isNMI())
         return;
 
-    uint32_t* linePtr = (uint32_t*)(screenPtr + displayY * 320 * 4);
-
-    if (currentScanline < TOP_BORDER_LINES || currentScanline >= TOP_BORDER_LINES + VISIBLE_LINES)
+    uint32_t steps;
+    uint16_t pc = z80->getRegPC();
+    if (contendedPage[pc >> 14])
     {
-        for (int x = 0; x < 320; x++)
-            linePtr[x] = borderColor;
+        // HALT en RAM contenida: cada M1 paga su contención
+        steps = 0;
+        while (tstates < limit)
+        {
+            tstates += contentionTable[tstates] + 4;
+            steps++;
+        }
     }
     else
     {
-        int speY = currentScanline - TOP_BORDER_LINES;
-        int ulaY = ((speY & 0xC0) | ((speY & 0x38) >> 3) | ((speY & 0x07) << 3));
+        steps = (limit - tstates + 3) / 4;
+        tstates += steps * 4;
+    }
 
-        int bmpBase = 0x4000 + (ulaY << 5);
-        int attBase = 0x5800 + ((speY >> 3) << 5);
+    z80->skipHalted(steps);
+}
 
-        uint8_t* bmpPtr = mem + bmpBase;
-        uint8_t* attPtr = mem + attBase;
+// Instrucciones que se ejecutan buscando el cierre de un bucle ocioso y
+// scanlines que se dejan pasar tras un sondeo fallido
+static const int IDLE_PROBE_INSTRUCTIONS = 64;
+static const int IDLE_PROBE_BACKOFF = 16;
+
+// Bucles de espera (KEY-INPUT de la ROM, DJNZ $, lecturas de 0xFE sin
+// cambios...). Se ejecuta de verdad una vuelta, sin pasar de probeLimit,
+// vigilando el bus: si vuelve al mismo PC con la CPU en el mismo estado
+// (salvo R), sin cambiar memoria, sin OUT ni lecturas que dependan del
+// tiempo, las siguientes vueltas son idénticas hasta 'limit' (la INT y el
+// teclado sólo cambian entre frames; con cinta el EAR cuenta como volátil)
+// y se contabilizan de golpe.
+void MinZX::skipIdleLoop(uint32_t probeLimit, uint32_t limit)
+{
+    if (idleBackoff > 0)
+    {
+        idleBackoff--;
+        return;
+    }
 
-        for (int x = 0; x < 32; x++)
-            linePtr[x] = borderColor;
+    if (tstates >= probeLimit || (intPending && z80->isIFF1()) || z80->isNMI() || z80->isHalted())
+        return;
 
-        for (int charX = 0; charX < 32; charX++)
-        {
-            uint8_t bmp = bmpPtr[charX];
-            uint8_t att = attPtr[charX];
+    uint16_t pc = z80->getRegPC();
 
-            int ink = att & 7;
-            int pap = (att >> 3) & 7;
-            bool br = (att & 0x40) != 0;
+    // DJNZ $: forma cerrada, 13 T-estados y un M1 por vuelta mientras B != 0
+    if (mem[pc] == 0x10 && mem[(uint16_t)(pc + 1)] == 0xFE &&
+        !contendedPage[pc >> 14] && !contendedPage[(uint16_t)(pc + 1) >> 14] &&
+        !contendedPage[z80->getRegI() >> 6])
+    {
+        z80->execute();
+        if (z80->getRegPC() != pc || z80->isHalted() || tstates >= limit)
+            return;
+
+        uint32_t n = (limit - tstates) / 13;
+        if (n > (uint32_t)(z80->getRegB() - 1))
+            n = z80->getRegB() - 1;
+        tstates += n * 13;
+        z80->setRegB(z80->getRegB() - n);
+        z80->advanceRegR(n);
+        return;
+    }
+
+    CPU::LoopState start, now;
+    z80->getLoopState(start);
+    uint8_t r0 = z80->getRegR();
+    uint32_t t0 = tstates;
 
-            uint32_t fore = 0;
-            uint32_t back = 0;
+    idleWrites = 0;
+    contendedAccesses = 0;
+    volatileIO = 0;
 
-            if (((att & 0x80) == 0) || (_flash_act == 0)) {
-                fore = zxColor(ink, br);
-                back = zxColor(pap, br);
+    for (int i = 0; i < IDLE_PROBE_INSTRUCTIONS && tstates < probeLimit; i++)
+    {
+        probing = true;
+        z80->execute();
+        probing = false;
+        if (idleWrites != 0 || volatileIO != 0 || z80->isHalted())
+            break;
+        if (z80->getRegPC() != pc)
+            continue;
+
+        z80->getLoopState(now);
+        if (!(now == start))
+            continue;
+
+        uint32_t n = 0;
+        if (contendedAccesses == 0)
+        {
+            // Sin contención todas las vueltas duran lo mismo
+            uint32_t period = tstates - t0;
+            if (tstates < limit)
+            {
+                n = (limit - tstates) / period;
+                tstates += n * period;
             }
-            else {
-                fore = zxColor(pap, br);
-                back = zxColor(ink, br);
+        }
+        else
+        {
+            if (contendedAccesses > IDLE_TRACE_MAX)
+                break;
+
+            // Cada vuelta repite los mismos accesos: se reproduce la traza
+            // sobre la tabla de contención partiendo del nuevo T-estado
+            const ContendedAccess& last = idleTrace[contendedAccesses - 1];
+            uint32_t tail = tstates - (last.tstate + last.delay);
+            uint32_t t = tstates;
+            while (t < limit)
+            {
+                uint32_t prev = t0;
+                for (uint32_t a = 0; a < contendedAccesses && t < limit; a++)
+                {
+                    t += idleTrace[a].tstate - prev;
+                    prev = idleTrace[a].tstate + idleTrace[a].delay;
+                    if (t < limit)
+                        t += contentionTable[t];
+                }
+                t += tail;
+                if (t > limit)
+                    break;
+                tstates = t;
+                n++;
             }
-
-
-            int px = 32 + charX * 8;
-            for (int bit = 7; bit >= 0; bit--)
-                linePtr[px++] = (bmp & (1 << bit)) ? fore : back;
         }
 
-        for (int x = 32 + 256; x < 320; x++)
-            linePtr[x] = borderColor;
+        z80->advanceRegR(n * ((z80->getRegR() - r0) & 0x7F));
+        return;
     }
+
+    idleBackoff = IDLE_PROBE_BACKOFF;
 }
 
-void MinZX::flushAudioBuffer(uint32_t upToTstate)
+// Pinta el frame hasta la posición del haz en el T-estado 't'
+void MinZX::renderUpTo(uint32_t t)
 {
-    if (upToTstate <= lastTstate) return;
-
-    uint32_t delta_t = upToTstate - lastTstate;
-    double delta_samples = static_cast<double>(delta_t) / TSTATES_PER_SAMPLE;
-    int num_samples = static_cast<int>(delta_samples + fractional);
-    fractional = delta_samples + fractional - static_cast<double>(num_samples);
+    if (screenPtr == nullptr)
+        return;
 
-    int16_t beeperLevel = speakerLevel ? HIGH_LEVEL : LOW_LEVEL;
+    uint32_t pos = t + LEFT_BORDER_TSTATES;
+    int scanline = pos / TSTATES_PER_SCANLINE;
+    int line = scanline - DISPLAY_FIRST_SCANLINE;
+    int x = (pos - scanline * TSTATES_PER_SCANLINE) * 2;
 
-    // Prepare tape buffer only when playing
-    std::vector<int16_t> tapeBuf;
-    tapeBuf.resize(num_samples);
-    /*if (tapePlayer && tapePlaying) {
-        tapePlayer->generateSamples(static_cast<size_t>(num_samples), tapeBuf.data());
+    if (line < 0)
+        return;
+    if (line >= DISPLAY_LINES)
+    {
+        line = DISPLAY_LINES;
+        x = 0;
     }
-    else {*/
-        for (int i = 0; i < num_samples; ++i) tapeBuf[i] = 0;
-    //}
+    else if (x > DISPLAY_WIDTH)
+        x = DISPLAY_WIDTH;
 
-    for (int i = 0; i < num_samples; ++i) {
-        int mixed = static_cast<int>(beeperLevel) + static_cast<int>(tapeBuf[i]);
-        if (mixed > INT16_MAX) mixed = INT16_MAX;
-        if (mixed < INT16_MIN) mixed = INT16_MIN;
-        audioBuffer.push_back(static_cast<int16_t>(mixed));
+    while (beamLine < line || (beamLine == line && beamX < x))
+    {
+        // Al entrar en una línea se decide si hay que pintarla: una línea
+        // limpia y con el mismo borde ya está en el buffer del frame anterior
+        uint32_t lineTstate = (beamLine + DISPLAY_FIRST_SCANLINE) * TSTATES_PER_SCANLINE
+                              - LEFT_BORDER_TSTATES;
+        if (beamX == 0)
+        {
+            uint8_t color = borderAt(lineTstate);
+            beamLineDraw = lineDirty[beamLine] || lineBorder[beamLine] != color;
+            lineDirty[beamLine] = false;
+            lineBorder[beamLine] = color;
+        }
+
+        // Línea con dos bordes: se termina de pintar y se repinta el frame que viene
+        int end = beamLine < line ? DISPLAY_WIDTH : x;
+        if (borderChangesBefore(lineTstate + (end + 1) / 2))
+        {
+            lineBorder[beamLine] = 0xFF;
+            beamLineDraw = true;
+        }
+
+        if (beamLineDraw)
+            renderSpan(beamLine, beamX, end);
+
+        beamX = end;
+        if (beamX == DISPLAY_WIDTH)
+        {
+            beamLine++;
+            beamX = 0;
+        }
     }
 }
 
-void MinZX::applyLowPassFilter()
+// Pinta las columnas [x0, x1) de la línea 'line' del buffer
+void MinZX::renderSpan(int line, int x0, int x1)
 {
-    if (audioBuffer.empty()) return;
+    uint8_t* linePtr = screenPtr + line * screenPitch;
 
-    int16_t prev = 0;
-    for (auto& sample : audioBuffer)
-    {
-        sample = static_cast<int16_t>(FILTER_ALPHA * sample + (1.0 - FILTER_ALPHA) * prev);
-        prev = sample;
-    }
+    if (line < updatedFirst)
+        updatedFirst = line;
+    if (line > updatedLast)
+        updatedLast = line;
+
+    if (frameFormat == FRAME_ARGB8888)
+        renderSpanTo((uint32_t*)linePtr, line, x0, x1);
+    else
+        renderSpanTo(linePtr, line, x0, x1);
 }
 
-void MinZX::updateULAFetchState()
+// Expansión de celdas y color del borde según el tipo de píxel del buffer
+void MinZX::expandCells(uint32_t* dst, const uint8_t* bmp, const uint8_t* att, int cells)
 {
-    uint32_t tInLine = tstates % TSTATES_PER_SCANLINE;
+    screenRow(dst, bmp, att, attrTable, cells);
+}
 
-    if (currentScanline < TOP_BORDER_LINES || currentScanline >= TOP_BORDER_LINES + VISIBLE_LINES)
+void MinZX::expandCells(uint8_t* dst, const uint8_t* bmp, const uint8_t* att, int cells)
+{
+    screenRowIndex(dst, bmp, att, attrIndexTable, cells);
+}
+
+static inline uint32_t borderPixel(const uint32_t*, uint8_t color) { return speColors[color]; }
+static inline uint8_t borderPixel(const uint8_t*, uint8_t color) { return color; }
+
+template <typename Pixel>
+void MinZX::renderSpanTo(Pixel* linePtr, int line, int x0, int x1)
+{
+    uint32_t lineTstate = (line + DISPLAY_FIRST_SCANLINE) * TSTATES_PER_SCANLINE
+                          - LEFT_BORDER_TSTATES;
+    int speY = line - (TOP_BORDER_LINES - DISPLAY_FIRST_SCANLINE);
+
+    if (speY < 0 || speY >= VISIBLE_LINES)
     {
-        isInVisibleArea = false;
-        ulaFetchPhase = -1;
-        currentVideoAddress = 0;
+        fillBorder(linePtr, lineTstate, x0, x1);
         return;
     }
 
-    isInVisibleArea = true;
+    int scrX0 = x0 > 32 ? x0 : 32;
+    int scrX1 = x1 < 32 + 256 ? x1 : 32 + 256;
+
+    if (x0 < 32)
+        fillBorder(linePtr, lineTstate, x0, x1 < 32 ? x1 : 32);
 
-    if (tInLine >= TSTATES_ACTIVE_FETCH)
+    if (scrX0 < scrX1)
     {
-        ulaFetchPhase = -1;
-        currentVideoAddress = 0;
+        int ulaY = ((speY & 0xC0) | ((speY & 0x38) >> 3) | ((speY & 0x07) << 3));
+        int firstCell = (scrX0 - 32) >> 3;
+        int lastCell = (scrX1 - 32 + 7) >> 3;
+        const uint8_t* bmpPtr = mem + 0x4000 + (ulaY << 5) + firstCell;
+        const uint8_t* attPtr = mem + 0x5800 + ((speY >> 3) << 5) + firstCell;
+
+        if (((scrX0 | scrX1) & 7) == 0)
+            expandCells(linePtr + scrX0, bmpPtr, attPtr, lastCell - firstCell);
+        else
+        {
+            // Celdas a medias: se expanden aparte y se copia el tramo
+            Pixel cells[256];
+            expandCells(cells, bmpPtr, attPtr, lastCell - firstCell);
+            memcpy(linePtr + scrX0, cells + ((scrX0 - 32) & 7), (scrX1 - scrX0) * sizeof(Pixel));
+        }
+    }
+
+    if (x1 > 32 + 256)
+        fillBorder(linePtr, lineTstate, x0 > 32 + 256 ? x0 : 32 + 256, x1);
+}
+
+// Cambio de borde (OUT a 0xFE): solo se apunta en el registro del frame,
+// el haz lo recoge al pintar
+void MinZX::changeBorder(uint8_t color)
+{
+    if (color == border)
         return;
+
+    border = color;
+    borderLog.push_back(BorderEvent{ tstates, color });
+}
+
+// Color del borde en el T-estado 't'. El haz solo avanza, así que el
+// cursor del registro tampoco retrocede dentro del frame
+uint8_t MinZX::borderAt(uint32_t t)
+{
+    while (borderCursor + 1 < borderLog.size() && borderLog[borderCursor + 1].tstate <= t)
+        borderCursor++;
+    return borderLog[borderCursor].color;
+}
+
+// ¿Hay algún cambio de borde después del vigente y antes del T-estado 't'?
+bool MinZX::borderChangesBefore(uint32_t t) const
+{
+    return borderCursor + 1 < borderLog.size() && borderLog[borderCursor + 1].tstate < t;
+}
+
+// Pinta las columnas [x0, x1) de borde de una línea como tramos de un
+// mismo color, uno por cada cambio registrado dentro de ellas
+template <typename Pixel>
+void MinZX::fillBorder(Pixel* linePtr, uint32_t lineTstate, int x0, int x1)
+{
+    int x = x0;
+    while (x < x1)
+    {
+        Pixel color = borderPixel(linePtr, borderAt(lineTstate + x / 2));
+
+        // El siguiente cambio entra en la primera columna cuyo T-estado lo alcanza
+        int end = x1;
+        if (borderChangesBefore(lineTstate + (x1 + 1) / 2))
+            end = (borderLog[borderCursor + 1].tstate - lineTstate) * 2;
+
+        std::fill_n(linePtr + x, end - x, color);
+        x = end;
     }
+}
 
-    int slot = tInLine / 8;
-    int subT = tInLine % 8;
+void MinZX::setFrameFormat(FrameFormat format)
+{
+    frameFormat = format;
+    if (format == FRAME_RGB565)
+        indexFrame.resize(DISPLAY_WIDTH * DISPLAY_LINES);
+    invalidateScreen();
+}
+
+void MinZX::setRenderMode(RenderMode mode, int interval)
+{
+    renderMode = mode;
+    renderInterval = interval > 0 ? interval : 1;
+    renderCountdown = 0;
+}
 
-    if (subT >= 4)
+bool MinZX::willRender() const
+{
+    switch (renderMode)
     {
-        ulaFetchPhase = -1;
-        currentVideoAddress = 0;
-        return;
+    case RENDER_EVERY_NTH:  return renderCountdown <= 0;
+    case RENDER_ON_REQUEST: return renderRequested;
+    case RENDER_NONE:       return false;
+    default:                return true;
     }
+}
 
-    ulaFetchPhase = slot;
+const uint32_t* MinZX::getPalette() const
+{
+    return speColors;
+}
 
-    int charX = slot * 2 + (subT / 2);
-    bool isAttr = (subT % 2) == 1;
+void MinZX::invalidateScreen()
+{
+    memset(lineDirty, 1, sizeof(lineDirty));
+}
 
-    int speY = currentScanline - TOP_BORDER_LINES;
-    int ulaY = ((speY & 0xC0) | ((speY & 0x38) >> 3) | ((speY & 0x07) << 3));
+bool MinZX::getUpdatedLines(int& first, int& last) const
+{
+    first = updatedFirst;
+    last = updatedLast;
+    return updatedLast >= updatedFirst;
+}
 
-    if (isAttr)
-        currentVideoAddress = 0x5800 + ((speY >> 3) << 5) + charX;
-    else
-        currentVideoAddress = 0x4000 + (ulaY << 5) + charX;
+// Cambio de fase del FLASH: solo cambian las filas de celdas con FLASH
+void MinZX::markFlashDirty()
+{
+    int top = TOP_BORDER_LINES - DISPLAY_FIRST_SCANLINE;
+
+    for (int row = 0; row < 24; row++)
+    {
+        const uint8_t* att = mem + 0x5800 + row * 32;
+        for (int x = 0; x < 32; x++)
+        {
+            if (att[x] & 0x80)
+            {
+                memset(&lineDirty[top + row * 8], 1, 8);
+                break;
+            }
+        }
+    }
 }
 
 uint8_t MinZX::processInputPort(uint16_t port)
@@ -416,6 +818,9 @@ uint8_t MinZX::processInputPort(uint16_t port)
         //    result &= (~0x40);
 
 
+        // Con cinta el bit EAR cambia con el tiempo
+        if (sTape) volatileIO++;
+
         if (Tape_GetEAR()) result &= ~(1 << 6);
         else               result |= (1 << 6);
 
@@ -423,15 +828,17 @@ uint8_t MinZX::processInputPort(uint16_t port)
         return result;
     }
 
+    // AY (0xFFFD): A15 = 1, A14 = 1, A1 = 0
+    if ((port & 0xC002) == 0xC000)
+        return ay.readRegister();
+
     // Floating bus para puertos no decodificados (excepto Kempston)
     if (lo != 0x1F)
     {
-        updateULAFetchState();
+        volatileIO++;
 
-        if (!isInVisibleArea || ulaFetchPhase < 0)
-            return 0xFF;
-
-        return mem[currentVideoAddress];
+        uint16_t address = floatingBusTable[tstates];
+        return address != 0 ? mem[address] : 0xFF;
     }
 
     return 0xFF; // Kempston o default
@@ -443,108 +850,177 @@ void MinZX::processOutputPort(uint16_t port, uint8_t value)
 
     if (lo == 0xFE)
     {
-        //flushAudioBuffer(tstates);
-        speakerLevel = (value & 0x10) != 0;
-        lastTstate = tstates;
+        beeper.setOutput(tstates, (value >> 3) & 0x03);
 
-        border = value & 0x07;
+        changeBorder(value & 0x07);
 
         tape.motor = !!(value & 0x08);
 
     }
-}
 
-void MinZX::keyPress(int row, int bit, bool press)
-{
-    if (press)
-        keymatrix[row] &= ~(1 << bit);
-    else
-        keymatrix[row] |= (1 << bit);
+    // AY: 0xFFFD selecciona registro (A14 = 1), 0xBFFD escribe (A14 = 0)
+    if ((port & 0x8002) == 0x8000)
+    {
+        if (port & 0x4000)
+            ay.selectRegister(value);
+        else
+            ay.writeRegister(tstates, value);
+    }
 }
 
-bool MinZX::isActiveINT(void)
+// LDIR/LDDR en bloque. Cada vuelta que repite: M1 en pc y pc+1, lectura de
+// src, escritura en dst y 2+5 ciclos con dst en el bus (21 T-estados sin
+// contención). Con origen y destino solapados en el sentido de la copia se
+// copia byte a byte, que es lo que hace el Z80 (relleno con LDIR).
+uint16_t MinZX::blockCopy(uint16_t pc, uint16_t src, uint16_t dst, uint16_t count,
+                          int step, uint32_t limit, uint8_t& last)
 {
-    return intPending;
-}
+    uint16_t n = 0;
 
-void MinZX::interruptHandlingTime(int32_t wstates)
-{
-    addTstates(wstates);
-    intPending = false;
-}
+    if (tstates >= limit)
+        return 0;
 
-unsigned char delay_contention(uint16_t address, unsigned int tstates)
-{
-    tstates += 1;
-    int line = tstates / 224;
-    if (line < 64 || line >= 256) return 0;
-    int halfpix = tstates % 224;
-    if (halfpix >= 128) return 0;
-    int modulo = halfpix % 8;
-    static unsigned char wait_states[8] = { 6,5,4,3,2,1,0,0 };
-    return wait_states[modulo];
-}
+    if (!contendedPage[pc >> 14] && !contendedPage[(uint16_t)(pc + 1) >> 14] &&
+        isUncontendedRange(src, count, step) && isUncontendedRange(dst, count, step))
+    {
+        uint32_t fit = (limit - tstates + 20) / 21;
+        n = fit < count ? fit : count;
+        tstates += n * 21;
 
-uint8_t MinZX::fetchOpcode(uint16_t address)
-{
-    if ((address >> 14) == 1)
-        addTstates(delay_contention(address, tstates));
-    addTstates(4);
-    return mem[address];
-}
+        uint16_t gap = step > 0 ? dst - src : src - dst;
+        if (gap != 0 && gap < n)
+        {
+            for (uint16_t i = 0; i < n; i++)
+                mem[(uint16_t)(dst + step * i)] = mem[(uint16_t)(src + step * i)];
+        }
+        else if (step > 0)
+            memmove(mem + dst, mem + src, n);
+        else
+            memmove(mem + dst - (n - 1), mem + src - (n - 1), n);
 
-uint8_t MinZX::peek8(uint16_t address)
-{
-    if ((address >> 14) == 1)
-        addTstates(delay_contention(address, tstates));
-    addTstates(3);
-    return mem[address];
+        last = mem[(uint16_t)(dst + step * (n - 1))];
+        return n;
+    }
+
+    while (n < count && tstates < limit)
+    {
+        if (contendedPage[pc >> 14])
+            contend();
+        addTstates(4);
+        if (contendedPage[(uint16_t)(pc + 1) >> 14])
+            contend();
+        addTstates(4);
+
+        last = peek8(src);
+        poke8(dst, last);
+        addressOnBus(dst, 2);
+        addressOnBus(dst, 5);
+
+        src += step;
+        dst += step;
+        n++;
+    }
+    return n;
 }
 
-void MinZX::poke8(uint16_t address, uint8_t value)
+// CPIR/CPDR en bloque: M1 en pc y pc+1, lectura de src y 5+5 ciclos con src
+// en el bus por vuelta. Se para antes del byte buscado.
+uint16_t MinZX::blockCompare(uint16_t pc, uint16_t src, uint16_t count, int step,
+                             uint8_t value, uint32_t limit, uint8_t& last)
 {
-    if ((address >> 14) == 1)
-        addTstates(delay_contention(address, tstates));
-    addTstates(3);
-    mem[address] = value;
+    uint16_t n = 0;
+
+    if (tstates >= limit)
+        return 0;
+
+    if (!contendedPage[pc >> 14] && !contendedPage[(uint16_t)(pc + 1) >> 14] &&
+        isUncontendedRange(src, count, step))
+    {
+        uint32_t fit = (limit - tstates + 20) / 21;
+        uint16_t max = fit < count ? fit : count;
+        while (n < max && mem[src] != value)
+        {
+            last = mem[src];
+            src += step;
+            n++;
+        }
+        tstates += n * 21;
+        return n;
+    }
+
+    while (n < count && tstates < limit && mem[src] != value)
+    {
+        if (contendedPage[pc >> 14])
+            contend();
+        addTstates(4);
+        if (contendedPage[(uint16_t)(pc + 1) >> 14])
+            contend();
+        addTstates(4);
+
+        last = peek8(src);
+        addressOnBus(src, 5);
+        addressOnBus(src, 5);
+
+        src += step;
+        n++;
+    }
+    return n;
 }
 
-uint16_t MinZX::peek16(uint16_t address)
+void MinZX::keyPress(int row, int bit, bool press)
 {
-    uint8_t lo = peek8(address);
-    uint8_t hi = peek8(address + 1);
-    return (hi << 8) | lo;
+    if (press)
+        keymatrix[row] &= ~(1 << bit);
+    else
+        keymatrix[row] |= (1 << bit);
 }
 
-void MinZX::poke16(uint16_t address, RegisterPair word)
+// Primeros 3 T-estados de un ciclo de I/O con los patrones de la ULA:
+//   byte alto contenido, bit 0 a 0:    C:1, C:3
+//   byte alto contenido, bit 0 a 1:    C:1, C:1, C:1, C:1
+//   byte alto sin contención, bit 0 a 0: N:1, C:3
+//   byte alto sin contención, bit 0 a 1: N:4
+// El bus se lee al final del tercero, como hasta ahora.
+void MinZX::contendPort(uint16_t port)
 {
-    poke8(address, word.byte8.lo);
-    poke8(address + 1, word.byte8.hi);
+    bool high = contendedPage[port >> 14];
+
+    if (high)
+        contend();
+    addTstates(1);
+
+    if ((port & 1) == 0)
+    {
+        contend();
+        addTstates(2);
+    }
+    else if (high)
+    {
+        contend();
+        addTstates(1);
+        contend();
+        addTstates(1);
+        contend();
+    }
+    else
+        addTstates(2);
 }
 
 uint8_t MinZX::inPort(uint16_t port)
 {
-    addTstates(3);
+    // IN sigue contando 3 T-estados, como en z80cpp
+    contendPort(port);
     return processInputPort(port);
 }
 
 void MinZX::outPort(uint16_t port, uint8_t value)
 {
-    addTstates(4);
+    contendPort(port);
+    addTstates(1);
+    volatileIO++;
     processOutputPort(port, value);
 }
 
-void MinZX::addressOnBus(uint16_t address, int32_t wstates)
-{
-    if ((address >> 14) == 1)
-    {
-        for (int i = 0; i < wstates; i++)
-            addTstates(delay_contention(address, tstates) + 1);
-    }
-    else
-        addTstates(wstates);
-}
-
 
 
 void MinZX::loadROM()
@@ -569,5 +1045,7 @@ void MinZX::destroy()
     delete z80;
     delete[] mem;
     delete[] ports;
+    delete[] contentionTable;
+    delete[] floatingBusTable;
     //if (tapePlayer) { delete tapePlayer; tapePlayer = nullptr; }
 }
\ No newline at end of file
@@ -6,14 +6,32 @@
 #include "z80.h"
 //#include "tzxplayer.h"
 #include "tape.h"
+#include "render.h"
+#include "beeper.h"
+#include "ay.h"
+#include "audiodsp.h"
 
 
+// Temporización de la ULA usada para generar la tabla de contención
+struct MachineTiming
+{
+    uint32_t frameTstates;        // T-estados por frame
+    uint32_t tstatesPerLine;      // T-estados por scanline
+    uint32_t firstContended;      // T-estado del primer acceso contenido
+};
 
-class MinZX : public Z80operations
+class MinZX final : public Z80operations
 {
 public:
+    // Núcleo Z80 ligado a MinZX en tiempo de compilación: los accesos a
+    // memoria, la contención y addTstates se expanden en línea en cada opcode
+    typedef Z80Core<MinZX> CPU;
+
     void init();
-    void update(uint8_t* screen);
+    // Ejecuta un frame y lo pinta en 'screen' (320x240 en el formato de
+    // setFrameFormat(), 'pitch' bytes por línea o 0 si no hay relleno;
+    // puede ser la memoria de una textura bloqueada)
+    void update(uint8_t* screen, int pitch = 0);
     void destroy();
     void reset();
     // Avanza tstates y notifica al reproductor de cinta
@@ -22,10 +40,60 @@ public:
     void setBorderColor(uint8_t bcol) { border = bcol; }
     void keyPress(int row, int bit, bool press);
 
-    Z80* getCPU() { return z80; }
+    // Timing del 48K para la tabla de contención
+    static const MachineTiming TIMING_48K;
+
+    CPU* getCPU() { return z80; }
+    // Si se escribe en la pantalla (0x4000-0x5AFF) a través de este puntero
+    // hay que llamar después a invalidateScreen()
     uint8_t* getMemory() { return mem; }
 
+    // Formato de los píxeles del frame. FRAME_INDEX8 deja el color del
+    // Spectrum (0..15) sin pasar por la paleta; FRAME_RGB565 pinta en
+    // índices y convierte las líneas repintadas al final del frame.
+    enum FrameFormat { FRAME_ARGB8888, FRAME_RGB565, FRAME_INDEX8 };
+    void setFrameFormat(FrameFormat format);
+    FrameFormat getFrameFormat() const { return frameFormat; }
+    // Colores ARGB8888 de los índices de FRAME_INDEX8
+    const uint32_t* getPalette() const;
+
+    // Qué frames se pintan. Los que no se pintan se emulan igual (bus
+    // flotante, FLASH, registro de borde...) y dejan el buffer como estaba;
+    // lo que cambie mientras tanto se repinta en el siguiente que se pinte.
+    //  RENDER_ALWAYS     todos
+    //  RENDER_EVERY_NTH  uno de cada 'interval'
+    //  RENDER_ON_REQUEST solo el siguiente a cada requestFrame()
+    //  RENDER_NONE       ninguno
+    enum RenderMode { RENDER_ALWAYS, RENDER_EVERY_NTH, RENDER_ON_REQUEST, RENDER_NONE };
+    void setRenderMode(RenderMode mode, int interval = 1);
+    void requestFrame() { renderRequested = true; }
+    // ¿Pintará el siguiente update()? Si no, no hace falta preparar el buffer
+    bool willRender() const;
+
+    // Fuerza a repintar todas las líneas en el siguiente update(). Hace
+    // falta cada frame si el buffer no conserva el frame anterior (p. ej.
+    // la memoria de SDL_LockTexture)
+    void invalidateScreen();
+    // Líneas del buffer (0..239) repintadas en el último update(); false si
+    // no ha cambiado ninguna y no hace falta volver a subir la textura
+    bool getUpdatedLines(int& first, int& last) const;
+
     const std::vector<int16_t>& getAudioBuffer() const { return audioBuffer; }
+    // Muestras por segundo del audio generado (44100 por defecto). El
+    // frontend la retoca un poco para no vaciar ni llenar su cola.
+    void setAudioSampleRate(uint32_t hz) { beeper.setRate(hz); ay.setRate(hz); }
+    static uint32_t getAudioSampleRate();
+    // Otra frecuencia base, si el dispositivo de audio no acepta la
+    // nominal. Conserva el estéreo y el modelo de altavoz.
+    void setAudioOutputRate(uint32_t hz);
+    // Reparto del AY en estéreo. Con AY_ABC o AY_ACB el audio sale en pares
+    // L/R intercalados (el beeper, igual en los dos).
+    void setAYStereo(AY::StereoMode mode) { ay.setStereo(mode); }
+    int getAudioChannels() const { return ay.channels(); }
+    // Filtros, ganancia y recorte del audio (por defecto, SPEAKER_LINE)
+    void setAudioDSP(const AudioDSPConfig& config) { dsp.configure(config); }
+    // Frames por segundo de la máquina emulada (50,08 en el 48K)
+    double getFrameRate() const;
     void clearAudioBuffer() { audioBuffer.clear(); }
 
     // Tape player control
@@ -39,16 +107,21 @@ public:
     */
 
 public:
-    virtual uint8_t  fetchOpcode(uint16_t address);
-    virtual uint8_t  peek8(uint16_t address);
-    virtual void     poke8(uint16_t address, uint8_t value);
-    virtual uint16_t peek16(uint16_t address);
-    virtual void     poke16(uint16_t address, RegisterPair word);
-    virtual uint8_t  inPort(uint16_t port);
-    virtual void     outPort(uint16_t port, uint8_t value);
-    virtual void     addressOnBus(uint16_t address, int32_t wstates);
-    virtual void     interruptHandlingTime(int32_t wstates);
-    virtual bool     isActiveINT(void);
+    virtual uint8_t  fetchOpcode(uint16_t address) override;
+    virtual uint8_t  peek8(uint16_t address) override;
+    virtual void     poke8(uint16_t address, uint8_t value) override;
+    virtual uint16_t peek16(uint16_t address) override;
+    virtual void     poke16(uint16_t address, RegisterPair word) override;
+    virtual uint8_t  inPort(uint16_t port) override;
+    virtual void     outPort(uint16_t port, uint8_t value) override;
+    virtual void     addressOnBus(uint16_t address, int32_t wstates) override;
+    virtual void     interruptHandlingTime(int32_t wstates) override;
+    virtual bool     isActiveINT(void) override;
+    virtual uint32_t getTstates(void) override { return tstates; }
+    virtual uint16_t blockCopy(uint16_t pc, uint16_t src, uint16_t dst, uint16_t count,
+                               int step, uint32_t limit, uint8_t &last) override;
+    virtual uint16_t blockCompare(uint16_t pc, uint16_t src, uint16_t count, int step,
+                                  uint8_t value, uint32_t limit, uint8_t &last) override;
 #ifdef WITH_BREAKPOINT_SUPPORT
     virtual uint8_t  breakpoint(uint16_t address, uint8_t opcode);
 #endif
@@ -59,7 +132,7 @@ public:
     Tape tape;
 
 private:
-    Z80* z80;
+    CPU* z80;
     uint8_t* mem;
     uint8_t* ports;
     uint32_t tstates;
@@ -68,6 +141,14 @@ private:
 
     uint32_t cycleTstates;
 
+    // Contención: retardo de un acceso que empieza en cada T-estado del frame
+    // (6,5,4,3,2,1,0,0 en la zona de pantalla, 0 fuera). Los patrones de I/O
+    // (C:1 C:3, N:1 C:3...) se resuelven con la misma tabla en contendPort().
+    uint8_t* contentionTable;
+    bool contendedPage[4];
+    void buildContentionTable(const MachineTiming& timing);
+    bool isUncontendedRange(uint16_t start, uint16_t count, int step);
+
     void loadROM();
     void loadDump();
 
@@ -78,29 +159,106 @@ private:
     uint8_t keymatrix[8];
     bool intPending;
 
-    // Audio (beeper)
-    bool speakerLevel;
-    uint32_t lastTstate;
-    double fractional;
+    // Audio: muestras de 16 bits a 44100 Hz del último frame
+    Beeper beeper;
+    AY ay;
+    AudioDSP dsp;
     std::vector<int16_t> audioBuffer;
 
-    void flushAudioBuffer(uint32_t upToTstate);
-    void applyLowPassFilter();
-
-    // Scanline-based rendering
+    // Render "catch-up": el frame se pinta a posteriori, hasta la posición
+    // del haz de la ULA. Antes de una escritura en pantalla se pinta hasta
+    // el T-estado actual, y el resto al final del frame. La columna x
+    // (0..319) de la scanline L sale en el T-estado L * 224 - 16 + x / 2
+    // (el píxel 0 de la pantalla, en L * 224).
     int currentScanline;          // 0..311
     uint32_t tstatesThisLine;
-    uint8_t* screenPtr;           // buffer ARGB8888 320x240
+    uint8_t* screenPtr;           // buffer en el que se pinta, 320x240
+    int screenPitch;              // bytes por línea de screenPtr
+    ScreenRowFn screenRow;        // expansión bitmap+atributos (SIMD si hay)
+    InkPaper attrTable[256];      // colores por atributo en la fase de FLASH actual
+    InkPaperIndex attrIndexTable[256];
+    // Contador de FLASH de esta máquina: corre también en los frames que
+    // no se pintan
+    int flashFrames;
+    bool flashActive;
 
-    void renderScanline();
-    uint32_t zxColor(int c, bool bright);
+    FrameFormat frameFormat;
+    uint8_t* outputPtr;           // buffer de update()
+    int outputPitch;
+    std::vector<uint8_t> indexFrame;      // FRAME_RGB565: frame en índices
+
+    RenderMode renderMode;
+    int renderInterval;
+    int renderCountdown;          // frames que faltan para pintar (EVERY_NTH)
+    bool renderRequested;
+    IndexToRGB565Fn indexToRGB565;
+    uint16_t rgb565Palette[16];
+
+    // Líneas sucias: solo se repintan las líneas del buffer cuya memoria de
+    // pantalla ha cambiado desde que se pintaron o cuyo borde es distinto.
+    // El buffer que se pasa a update() tiene que conservar el frame anterior.
+    bool lineDirty[240];
+    uint8_t lineBorder[240];      // color de borde con el que se pintó cada línea
+    int updatedFirst, updatedLast;
 
-    // Floating bus
-    int ulaFetchPhase;            // -1 = idle, 0..15 = slot activo
-    bool isInVisibleArea;
-    uint16_t currentVideoAddress;
+    void markScreenDirty(uint16_t address);
+    void markFlashDirty();
 
-    void updateULAFetchState();
+    // Haz: línea del buffer (0..240) y columna (0..319) pintadas hasta ahora
+    int beamLine, beamX;
+    bool beamLineDraw;            // la línea del haz está sucia: se pinta
+    void renderUpTo(uint32_t t);
+    void renderSpan(int line, int x0, int x1);
+    template <typename Pixel> void renderSpanTo(Pixel* linePtr, int line, int x0, int x1);
+    void expandCells(uint32_t* dst, const uint8_t* bmp, const uint8_t* att, int cells);
+    void expandCells(uint8_t* dst, const uint8_t* bmp, const uint8_t* att, int cells);
+
+    // Registro de cambios de borde del frame (OUT a 0xFE). La primera
+    // entrada es el color con el que empieza el frame; el borde se pinta
+    // luego por tramos de un mismo color a partir del registro.
+    struct BorderEvent
+    {
+        uint32_t tstate;
+        uint8_t color;
+    };
+    std::vector<BorderEvent> borderLog;
+    uint32_t borderCursor;        // evento vigente en la posición del haz
+
+    void changeBorder(uint8_t color);
+    uint8_t borderAt(uint32_t t);
+    bool borderChangesBefore(uint32_t t) const;
+    template <typename Pixel> void fillBorder(Pixel* linePtr, uint32_t lineTstate, int x0, int x1);
+
+    void skipHalt(uint32_t limit);
+
+    // Bucles ociosos: contadores que los métodos del bus actualizan mientras
+    // skipIdleLoop() sondea una vuelta del bucle
+    uint32_t idleWrites;          // escrituras que cambian la memoria
+    uint32_t contendedAccesses;   // accesos a páginas contenidas
+    bool probing;                 // contend() solo traza durante el sondeo
+    uint32_t volatileIO;          // OUT, bus flotante, EAR con cinta
+    int idleBackoff;              // scanlines sin sondear tras un fallo
+
+    // Traza de los accesos contenidos (T-estado y retardo) de la vuelta
+    // sondeada, para recalcular la duración de las siguientes
+    struct ContendedAccess
+    {
+        uint32_t tstate;
+        uint8_t delay;
+    };
+    static const uint32_t IDLE_TRACE_MAX = 64;
+    ContendedAccess idleTrace[IDLE_TRACE_MAX];
+
+    void contend();
+    void contendPort(uint16_t port);
+    void skipIdleLoop(uint32_t probeLimit, uint32_t limit);
+
+    uint32_t zxColor(int c, bool bright);
+
+    // Bus flotante: dirección que lee la ULA en cada T-estado del frame
+    // (0 = no lee, el bus queda a 0xFF)
+    uint16_t* floatingBusTable;
+    void buildFloatingBusTable(const MachineTiming& timing);
 
     // Tape player pointer (MinZX owns it) + playing flag
     //TzxPlayer* tapePlayer = nullptr;
@@ -112,6 +270,139 @@ private:
     static const int TSTATES_PER_SCANLINE = 224;
     static const int FETCH_SLOTS_PER_LINE = 16;
     static const int TSTATES_ACTIVE_FETCH = 128;
+    static const int DISPLAY_LINES = 240;
+    static const int DISPLAY_FIRST_SCANLINE = TOP_BORDER_LINES - 24;
+    static const int DISPLAY_WIDTH = 320;
+    static const int LEFT_BORDER_TSTATES = 16;
 };
 
+extern template class Z80Core<MinZX>;
+
+// ─────────────────────────────────────────────────────────────
+// Bus: métodos llamados en cada instrucción, definidos aquí para que
+// Z80Core<MinZX> los expanda en línea
+// ─────────────────────────────────────────────────────────────
+
+// Incrementa tstates y notifica al TzxPlayer si está reproduciendo
+inline void MinZX::addTstates(uint32_t delta)
+{
+    if (delta == 0) return;
+    tstates += delta;
+    /*if (tapePlayer && tapePlaying) {
+        tapePlayer->advanceByTstates(delta);
+    }*/
+}
+
+// Retardo por contención del acceso que empieza ahora
+inline void MinZX::contend()
+{
+    uint8_t delay = contentionTable[tstates];
+    if (probing)
+    {
+        if (contendedAccesses < IDLE_TRACE_MAX)
+            idleTrace[contendedAccesses] = { tstates, delay };
+        contendedAccesses++;
+    }
+    addTstates(delay);
+}
+
+inline uint8_t MinZX::fetchOpcode(uint16_t address)
+{
+    if (contendedPage[address >> 14])
+        contend();
+    addTstates(4);
+    return mem[address];
+}
+
+inline uint8_t MinZX::peek8(uint16_t address)
+{
+    if (contendedPage[address >> 14])
+        contend();
+    addTstates(3);
+    return mem[address];
+}
+
+inline void MinZX::poke8(uint16_t address, uint8_t value)
+{
+    if (contendedPage[address >> 14])
+        contend();
+    addTstates(3);
+    if (mem[address] != value)
+    {
+        idleWrites++;
+        if ((uint16_t)(address - 0x4000) < 0x1B00)
+        {
+            renderUpTo(tstates);
+            markScreenDirty(address);
+        }
+    }
+    mem[address] = value;
+}
+
+// Marca la línea (bitmap) o las 8 líneas (atributos) que dependen de
+// 'address'. Si el haz está a mitad de una de ellas, el resto se pinta ya
+// en este frame con el valor nuevo.
+inline void MinZX::markScreenDirty(uint16_t address)
+{
+    uint16_t offset = address - 0x4000;
+    int top = TOP_BORDER_LINES - DISPLAY_FIRST_SCANLINE;
+    int first, count;
+
+    if (offset < 0x1800)
+    {
+        int ulaY = offset >> 5;
+        first = top + ((ulaY & 0xC0) | ((ulaY & 0x07) << 3) | ((ulaY >> 3) & 0x07));
+        count = 1;
+    }
+    else
+    {
+        first = top + (((offset - 0x1800) >> 5) << 3);
+        count = 8;
+    }
+
+    for (int i = 0; i < count; i++)
+        lineDirty[first + i] = true;
+
+    if (beamX > 0 && beamLine >= first && beamLine < first + count)
+        beamLineDraw = true;
+}
+
+inline uint16_t MinZX::peek16(uint16_t address)
+{
+    uint8_t lo = peek8(address);
+    uint8_t hi = peek8(address + 1);
+    return (hi << 8) | lo;
+}
+
+inline void MinZX::poke16(uint16_t address, RegisterPair word)
+{
+    poke8(address, word.byte8.lo);
+    poke8(address + 1, word.byte8.hi);
+}
+
+inline void MinZX::addressOnBus(uint16_t address, int32_t wstates)
+{
+    if (contendedPage[address >> 14])
+    {
+        for (int i = 0; i < wstates; i++)
+        {
+            contend();
+            addTstates(1);
+        }
+    }
+    else
+        addTstates(wstates);
+}
+
+inline bool MinZX::isActiveINT(void)
+{
+    return intPending;
+}
+
+inline void MinZX::interruptHandlingTime(int32_t wstates)
+{
+    addTstates(wstates);
+    intPending = false;
+}
+
 #endif // _MINZX_H_
\ No newline at end of file
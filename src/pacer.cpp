@@ -0,0 +1,96 @@
+#include "pacer.h"
+
+// Corrección máxima: la del periodo no se nota, la de la frecuencia de
+// muestreo es un cambio de tono y tiene que quedarse por debajo de lo audible
+static const double MAX_PERIOD_ADJUST = 0.05;
+static const double MAX_RATE_ADJUST = 0.005;
+
+// El nivel de la cola salta a trozos (el callback se lleva un buffer de
+// golpe): se suaviza con una media exponencial de unos 16 frames
+static const double FILL_SMOOTHING = 1.0 / 16;
+
+void FramePacer::init(Mode mode, double frameRate, uint32_t sampleRate, uint32_t targetFill)
+{
+    this->mode = mode;
+    nominalFrameRate = frameRate;
+    nominalSampleRate = sampleRate;
+    period = 1.0 / frameRate;
+    this->targetFill = targetFill;
+    maxAdjust = mode == PACE_VSYNC ? MAX_RATE_ADJUST : MAX_PERIOD_ADJUST;
+
+    started = false;
+    deadline = 0.0;
+    avgFill = targetFill;
+    adjust = 0.0;
+    reportFrames = 0;
+    reportStart = 0.0;
+}
+
+double FramePacer::frameDone(double now, uint32_t fill)
+{
+    if (!started)
+    {
+        started = true;
+        deadline = now;
+        reportStart = now;
+    }
+    reportFrames++;
+
+    // Controlador proporcional sobre el nivel medio: con la cola a medias
+    // del objetivo se aplica la corrección máxima
+    avgFill += (fill - avgFill) * FILL_SMOOTHING;
+    if (mode != PACE_TIMER)
+    {
+        adjust = 2.0 * maxAdjust * (targetFill - avgFill) / targetFill;
+        if (adjust > maxAdjust) adjust = maxAdjust;
+        if (adjust < -maxAdjust) adjust = -maxAdjust;
+    }
+
+    if (mode == PACE_VSYNC)
+        return 0.0;
+
+    // Si la cola está casi vacía el siguiente frame va ya, y el plazo se
+    // cuenta desde ahora
+    if (mode == PACE_AUDIO && fill < targetFill / 4)
+    {
+        deadline = now;
+        return 0.0;
+    }
+
+    // Falta audio (adjust > 0): frames más cortos
+    double framePeriod = period * (1.0 - adjust);
+
+    // El plazo se acumula, así el redondeo de cada espera no se va sumando.
+    // Si vamos más de un frame tarde (una pausa larga) no se intenta
+    // recuperar a toda velocidad: se sigue desde ahora.
+    deadline += framePeriod;
+    double wait = deadline - now;
+    if (wait < -framePeriod)
+    {
+        deadline = now;
+        wait = 0.0;
+    }
+
+    return wait > 0.0 ? wait : 0.0;
+}
+
+uint32_t FramePacer::sampleRate() const
+{
+    if (mode != PACE_VSYNC)
+        return nominalSampleRate;
+    return (uint32_t)(nominalSampleRate * (1.0 + adjust) + 0.5);
+}
+
+FramePacer::Report FramePacer::takeReport(double now)
+{
+    Report report;
+    double elapsed = now - reportStart;
+    report.frameRate = elapsed > 0.0 ? reportFrames / elapsed : 0.0;
+    report.driftPpm = (report.frameRate / nominalFrameRate - 1.0) * 1e6;
+    report.latencyMs = avgFill * 1000.0 / nominalSampleRate;
+    report.adjustPpm = adjust * 1e6;
+
+    reportFrames = 0;
+    reportStart = now;
+    return report;
+}
@@ -0,0 +1,58 @@
+#ifndef _PACER_H_
+#define _PACER_H_
+
+#include <inttypes.h>
+
+// Ritmo de los frames. El reloj que manda es el de la salida de audio:
+//  PACE_TIMER  sin audio, un frame cada 1 / frameRate segundos
+//  PACE_AUDIO  como PACE_TIMER, pero el periodo se acorta o alarga (hasta
+//              un 5%) para que la cola de audio se quede en 'targetFill'
+//  PACE_VSYNC  el ritmo lo da el present con vsync (pantalla a ~50 Hz); lo
+//              que se corrige, hasta un ±0,5%, es la frecuencia de muestreo
+//              del audio generado
+// Así la cola ni se vacía (chasquidos) ni crece (latencia).
+class FramePacer
+{
+public:
+    enum Mode { PACE_TIMER, PACE_AUDIO, PACE_VSYNC };
+
+    // 'frameRate' de la máquina emulada, 'sampleRate' nominal del audio
+    void init(Mode mode, double frameRate, uint32_t sampleRate, uint32_t targetFill);
+    Mode getMode() const { return mode; }
+
+    // Al terminar cada frame, ya encolado su audio: 'now' en segundos y
+    // 'fill' muestras en la cola. Devuelve los segundos que hay que esperar
+    // antes de empezar el siguiente (0 con PACE_VSYNC).
+    double frameDone(double now, uint32_t fill);
+
+    // Frecuencia de muestreo con la que generar el siguiente frame
+    uint32_t sampleRate() const;
+
+    struct Report
+    {
+        double frameRate;       // frames por segundo medidos
+        double driftPpm;        // diferencia con los de la máquina
+        double latencyMs;       // lo que tarda en sonar una muestra nueva (media)
+        double adjustPpm;       // corrección aplicada ahora
+    };
+    // Medidas desde el informe anterior
+    Report takeReport(double now);
+
+private:
+    Mode mode;
+    double nominalFrameRate;
+    uint32_t nominalSampleRate;
+    double period;              // segundos por frame
+    double targetFill;
+    double maxAdjust;
+
+    bool started;
+    double deadline;            // cuándo debería empezar el siguiente frame
+    double avgFill;             // nivel de la cola suavizado
+    double adjust;              // corrección relativa, ±maxAdjust
+
+    uint32_t reportFrames;
+    double reportStart;
+};
+
+#endif
@@ -0,0 +1,252 @@
+#include "render.h"
+#include <string.h>
+
+#ifdef RENDER_WITH_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(RENDER_WITH_SSSE3) || defined(RENDER_WITH_AVX2)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Máscara de cada uno de los 8 píxeles de un byte de bitmap
+// (0xFFFFFFFF = tinta, 0 = papel)
+static uint32_t bitmapMask[256][8];
+
+// Las mismas máscaras con un byte por píxel, en el orden de la memoria
+static uint64_t bitmapMask8[256];
+
+static void buildBitmapMasks()
+{
+    for (int pixels = 0; pixels < 256; pixels++)
+    {
+        uint8_t bytes[8];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            bitmapMask[pixels][bit] = (pixels & (0x80 >> bit)) ? 0xFFFFFFFF : 0;
+            bytes[bit] = (pixels & (0x80 >> bit)) ? 0xFF : 0;
+        }
+        memcpy(&bitmapMask8[pixels], bytes, 8);
+    }
+}
+
+void buildAttrTable(InkPaper* table, const uint32_t* palette, bool flash)
+{
+    for (int att = 0; att < 256; att++)
+    {
+        const uint32_t* pal = palette + ((att & 0x40) >> 3);   // brillo: 8..15
+        uint32_t ink = pal[att & 7];
+        uint32_t paper = pal[(att >> 3) & 7];
+
+        if ((att & 0x80) && flash) {
+            table[att].ink = paper;
+            table[att].paper = ink;
+        }
+        else {
+            table[att].ink = ink;
+            table[att].paper = paper;
+        }
+    }
+}
+
+// Cada píxel es papel ^ ((tinta ^ papel) & máscara): sin saltos
+void screenRowScalar(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                     const InkPaper* attrTable, int cells)
+{
+    for (int charX = 0; charX < cells; charX++, dst += 8)
+    {
+        const InkPaper& colors = attrTable[att[charX]];
+        const uint32_t* mask = bitmapMask[bmp[charX]];
+        uint32_t diff = colors.ink ^ colors.paper;
+
+        for (int bit = 0; bit < 8; bit++)
+            dst[bit] = colors.paper ^ (diff & mask[bit]);
+    }
+}
+
+#ifdef RENDER_WITH_SSE2
+// Cada celda son dos vectores de 4 píxeles: el byte de bitmap se replica
+// en los 4 carriles, se compara con el bit de cada píxel y la máscara
+// resultante elige entre tinta y papel
+void screenRowSSE2(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                   const InkPaper* attrTable, int cells)
+{
+    const __m128i bitsHi = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+    const __m128i bitsLo = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+
+    for (int charX = 0; charX < cells; charX++, dst += 8)
+    {
+        const InkPaper& colors = attrTable[att[charX]];
+
+        __m128i pixels = _mm_set1_epi32(bmp[charX]);
+        __m128i ink = _mm_set1_epi32((int)colors.ink);
+        __m128i paper = _mm_set1_epi32((int)colors.paper);
+
+        __m128i maskHi = _mm_cmpeq_epi32(_mm_and_si128(pixels, bitsHi), bitsHi);
+        __m128i maskLo = _mm_cmpeq_epi32(_mm_and_si128(pixels, bitsLo), bitsLo);
+
+        _mm_storeu_si128((__m128i*)dst,
+            _mm_or_si128(_mm_and_si128(maskHi, ink), _mm_andnot_si128(maskHi, paper)));
+        _mm_storeu_si128((__m128i*)(dst + 4),
+            _mm_or_si128(_mm_and_si128(maskLo, ink), _mm_andnot_si128(maskLo, paper)));
+    }
+}
+#endif
+
+#ifdef RENDER_WITH_AVX2
+// Igual que la SSE2, pero la celda entera cabe en un vector de 8 píxeles
+#ifdef __GNUC__
+__attribute__((target("avx2")))
+#endif
+void screenRowAVX2(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                   const InkPaper* attrTable, int cells)
+{
+    const __m256i bits = _mm256_set_epi32(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+
+    for (int charX = 0; charX < cells; charX++, dst += 8)
+    {
+        const InkPaper& colors = attrTable[att[charX]];
+
+        __m256i pixels = _mm256_set1_epi32(bmp[charX]);
+        __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, bits), bits);
+
+        _mm256_storeu_si256((__m256i*)dst,
+            _mm256_blendv_epi8(_mm256_set1_epi32((int)colors.paper),
+                               _mm256_set1_epi32((int)colors.ink), mask));
+    }
+}
+
+// AVX2 necesita soporte de la CPU y que el SO guarde los registros YMM
+static bool cpuHasAVX2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef RENDER_WITH_SSSE3
+static bool cpuHasSSSE3()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[2] & (1 << 9)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+#endif
+
+ScreenRowFn selectScreenRowKernel()
+{
+    buildBitmapMasks();
+
+#ifdef RENDER_WITH_AVX2
+    if (cpuHasAVX2())
+        return screenRowAVX2;
+#endif
+#ifdef RENDER_WITH_SSE2
+    return screenRowSSE2;
+#else
+    return screenRowScalar;
+#endif
+}
+
+void buildAttrIndexTable(InkPaperIndex* table, bool flash)
+{
+    for (int att = 0; att < 256; att++)
+    {
+        uint8_t bright = (att & 0x40) >> 3;
+        uint8_t ink = bright | (att & 7);
+        uint8_t paper = bright | ((att >> 3) & 7);
+
+        bool swap = (att & 0x80) && flash;
+        table[att].ink = swap ? paper : ink;
+        table[att].paper = swap ? ink : paper;
+    }
+}
+
+void screenRowIndex(uint8_t* dst, const uint8_t* bmp, const uint8_t* att,
+                    const InkPaperIndex* attrTable, int cells)
+{
+    const uint64_t bytes = 0x0101010101010101ULL;
+
+    for (int charX = 0; charX < cells; charX++, dst += 8)
+    {
+        const InkPaperIndex& colors = attrTable[att[charX]];
+        uint64_t paper = colors.paper * bytes;
+        uint64_t diff = (colors.ink ^ colors.paper) * bytes;
+        uint64_t pixels = paper ^ (diff & bitmapMask8[bmp[charX]]);
+        memcpy(dst, &pixels, 8);
+    }
+}
+
+uint16_t toRGB565(uint32_t argb)
+{
+    return (uint16_t)(((argb >> 8) & 0xF800) | ((argb >> 5) & 0x07E0) | ((argb >> 3) & 0x001F));
+}
+
+void indexToRGB565Scalar(uint16_t* dst, const uint8_t* src, int count,
+                         const uint16_t* palette)
+{
+    for (int i = 0; i < count; i++)
+        dst[i] = palette[src[i] & 0x0F];
+}
+
+#ifdef RENDER_WITH_SSSE3
+// Con 16 colores la paleta cabe en un registro: PSHUFB traduce 16 índices
+// a la vez, una vez para el byte bajo y otra para el alto de cada color
+#ifdef __GNUC__
+__attribute__((target("ssse3")))
+#endif
+void indexToRGB565SSSE3(uint16_t* dst, const uint8_t* src, int count,
+                        const uint16_t* palette)
+{
+    uint8_t lo[16], hi[16];
+    for (int c = 0; c < 16; c++)
+    {
+        lo[c] = palette[c] & 0xFF;
+        hi[c] = palette[c] >> 8;
+    }
+    const __m128i lutLo = _mm_loadu_si128((const __m128i*)lo);
+    const __m128i lutHi = _mm_loadu_si128((const __m128i*)hi);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i index = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + i)), nibble);
+        __m128i pixLo = _mm_shuffle_epi8(lutLo, index);
+        __m128i pixHi = _mm_shuffle_epi8(lutHi, index);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(pixLo, pixHi));
+        _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(pixLo, pixHi));
+    }
+    indexToRGB565Scalar(dst + i, src + i, count - i, palette);
+}
+#endif
+
+IndexToRGB565Fn selectIndexToRGB565()
+{
+#ifdef RENDER_WITH_SSSE3
+    if (cpuHasSSSE3())
+        return indexToRGB565SSSE3;
+#endif
+    return indexToRGB565Scalar;
+}
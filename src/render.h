@@ -0,0 +1,79 @@
+#ifndef _RENDER_H_
+#define _RENDER_H_
+
+#include <inttypes.h>
+#include "simd.h"
+
+// Tinta y papel de un byte de atributos, con la fase de FLASH ya aplicada
+struct InkPaper
+{
+    uint32_t ink;
+    uint32_t paper;
+};
+
+// Rellena las 256 entradas de 'table' a partir de los 16 colores de
+// 'palette' (8 normales + 8 con brillo). 'flash' es la fase actual del
+// FLASH (true = tinta y papel intercambiados). Solo hay que rehacerla
+// cuando cambia la paleta o la fase.
+void buildAttrTable(InkPaper* table, const uint32_t* palette, bool flash);
+
+// Expande 'cells' celdas de una fila de pantalla (un byte de bitmap y uno
+// de atributos por celda) en cells * 8 píxeles ARGB. Una fila completa
+// son 32 celdas.
+typedef void (*ScreenRowFn)(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                            const InkPaper* attrTable, int cells);
+
+// Versión portable, la referencia para las demás
+void screenRowScalar(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                     const InkPaper* attrTable, int cells);
+
+#ifdef SIMD_SSE2
+#define RENDER_WITH_SSE2 1
+void screenRowSSE2(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                   const InkPaper* attrTable, int cells);
+
+#ifdef SIMD_X86_TARGETS
+#define RENDER_WITH_SSSE3 1
+#define RENDER_WITH_AVX2 1
+void screenRowAVX2(uint32_t* dst, const uint8_t* bmp, const uint8_t* att,
+                   const InkPaper* attrTable, int cells);
+#endif
+#endif
+
+// La mejor versión que soporta la CPU en la que se ejecuta. Hay que
+// llamarla antes de usar cualquiera de ellas (prepara sus tablas),
+// también antes de screenRowIndex().
+ScreenRowFn selectScreenRowKernel();
+
+// Framebuffer indexado: un byte por píxel con el color del Spectrum
+// (0..7, 8..15 con brillo). La paleta se aplica después, o nunca.
+struct InkPaperIndex
+{
+    uint8_t ink;
+    uint8_t paper;
+};
+
+void buildAttrIndexTable(InkPaperIndex* table, bool flash);
+
+// Como ScreenRowFn, pero con un byte por píxel: cada celda se compone en
+// un entero de 64 bits y se escribe de una vez
+void screenRowIndex(uint8_t* dst, const uint8_t* bmp, const uint8_t* att,
+                    const InkPaperIndex* attrTable, int cells);
+
+// Color ARGB8888 a RGB565
+uint16_t toRGB565(uint32_t argb);
+
+// Convierte 'count' píxeles indexados a RGB565 con 'palette' (16 colores)
+typedef void (*IndexToRGB565Fn)(uint16_t* dst, const uint8_t* src, int count,
+                                const uint16_t* palette);
+
+void indexToRGB565Scalar(uint16_t* dst, const uint8_t* src, int count,
+                         const uint16_t* palette);
+#ifdef RENDER_WITH_SSSE3
+void indexToRGB565SSSE3(uint16_t* dst, const uint8_t* src, int count,
+                        const uint16_t* palette);
+#endif
+
+IndexToRGB565Fn selectIndexToRGB565();
+
+#endif
@@ -0,0 +1,243 @@
+#include "scaler.h"
+#include "simd.h"
+#include <string.h>
+
+#ifdef SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// Vecinos de cada píxel E (los bordes del frame se repiten):
+//   A B C
+//   D E F
+//   G H I
+
+// Scale2x: cada píxel pasa a 2x2; una esquina toma el color de los dos
+// vecinos que la tocan si son iguales (y no es un cruce o una línea)
+static inline void epx2xPixel(uint32_t* out0, uint32_t* out1, const uint32_t* above,
+                              const uint32_t* row, const uint32_t* below, int x, int width)
+{
+    uint32_t B = above[x], H = below[x], E = row[x];
+    uint32_t D = row[x > 0 ? x - 1 : x];
+    uint32_t F = row[x < width - 1 ? x + 1 : x];
+
+    uint32_t E0 = E, E1 = E, E2 = E, E3 = E;
+    if (B != H && D != F)
+    {
+        if (D == B) E0 = D;
+        if (B == F) E1 = F;
+        if (D == H) E2 = D;
+        if (H == F) E3 = F;
+    }
+    out0[2 * x] = E0;
+    out0[2 * x + 1] = E1;
+    out1[2 * x] = E2;
+    out1[2 * x + 1] = E3;
+}
+
+// Scale3x: igual, a 3x3, con las reglas de AdvanceMAME para los lados
+static inline void epx3xPixel(uint32_t* out0, uint32_t* out1, uint32_t* out2, const uint32_t* above,
+                              const uint32_t* row, const uint32_t* below, int x, int width)
+{
+    int l = x > 0 ? x - 1 : x;
+    int r = x < width - 1 ? x + 1 : x;
+    uint32_t A = above[l], B = above[x], C = above[r];
+    uint32_t D = row[l], E = row[x], F = row[r];
+    uint32_t G = below[l], H = below[x], I = below[r];
+
+    uint32_t E0 = E, E1 = E, E2 = E, E3 = E, E5 = E, E6 = E, E7 = E, E8 = E;
+    if (B != H && D != F)
+    {
+        if (D == B) E0 = D;
+        if ((D == B && E != C) || (B == F && E != A)) E1 = B;
+        if (B == F) E2 = F;
+        if ((D == B && E != G) || (D == H && E != A)) E3 = D;
+        if ((B == F && E != I) || (H == F && E != C)) E5 = F;
+        if (D == H) E6 = D;
+        if ((D == H && E != I) || (H == F && E != G)) E7 = H;
+        if (H == F) E8 = F;
+    }
+    out0[3 * x] = E0; out0[3 * x + 1] = E1; out0[3 * x + 2] = E2;
+    out1[3 * x] = E3; out1[3 * x + 1] = E;  out1[3 * x + 2] = E5;
+    out2[3 * x] = E6; out2[3 * x + 1] = E7; out2[3 * x + 2] = E8;
+}
+
+#ifdef SIMD_SSE2
+// mask ? a : b, carril a carril
+static inline __m128i select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Entrelaza tres vectores de 4 píxeles: a0 b0 c0 a1 b1 c1 a2 b2 c2 a3 b3 c3
+static inline void store3(uint32_t* dst, __m128i a, __m128i b, __m128i c)
+{
+    __m128 fa = _mm_castsi128_ps(a), fb = _mm_castsi128_ps(b), fc = _mm_castsi128_ps(c);
+
+    __m128 ab01 = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b));                  // a0 b0 a1 b1
+    __m128 c0a1 = _mm_shuffle_ps(fc, fa, _MM_SHUFFLE(1, 1, 0, 0));              // c0 c0 a1 a1
+    __m128 b1c1 = _mm_shuffle_ps(fb, fc, _MM_SHUFFLE(1, 1, 1, 1));              // b1 b1 c1 c1
+    __m128 a2b2 = _mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 2, 2, 2));              // a2 a2 b2 b2
+    __m128 c2a3 = _mm_shuffle_ps(fc, fa, _MM_SHUFFLE(3, 3, 2, 2));              // c2 c2 a3 a3
+    __m128 b3c3 = _mm_shuffle_ps(fb, fc, _MM_SHUFFLE(3, 3, 3, 3));              // b3 b3 c3 c3
+
+    _mm_storeu_ps((float*)dst, _mm_shuffle_ps(ab01, c0a1, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps((float*)(dst + 4), _mm_shuffle_ps(b1c1, a2b2, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps((float*)(dst + 8), _mm_shuffle_ps(c2a3, b3c3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
+static void nearestRow(uint32_t* out, const uint32_t* row, int width, int factor)
+{
+    int x = 0;
+#ifdef SIMD_SSE2
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(row + x));
+        if (factor == 2)
+        {
+            _mm_storeu_si128((__m128i*)(out + 2 * x), _mm_unpacklo_epi32(p, p));
+            _mm_storeu_si128((__m128i*)(out + 2 * x + 4), _mm_unpackhi_epi32(p, p));
+        }
+        else
+            store3(out + 3 * x, p, p, p);
+    }
+#endif
+    for (; x < width; x++)
+        for (int i = 0; i < factor; i++)
+            out[factor * x + i] = row[x];
+}
+
+static void epx2xRow(uint32_t* out0, uint32_t* out1, const uint32_t* above,
+                     const uint32_t* row, const uint32_t* below, int width)
+{
+    int x = 0;
+#ifdef SIMD_SSE2
+    // El primer píxel (sin vecino a la izquierda) va por la versión escalar
+    epx2xPixel(out0, out1, above, row, below, x++, width);
+    for (; x + 4 < width; x += 4)
+    {
+        __m128i B = _mm_loadu_si128((const __m128i*)(above + x));
+        __m128i H = _mm_loadu_si128((const __m128i*)(below + x));
+        __m128i D = _mm_loadu_si128((const __m128i*)(row + x - 1));
+        __m128i E = _mm_loadu_si128((const __m128i*)(row + x));
+        __m128i F = _mm_loadu_si128((const __m128i*)(row + x + 1));
+
+        __m128i edge = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+        __m128i E0 = select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(D, B)), D, E);
+        __m128i E1 = select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(B, F)), F, E);
+        __m128i E2 = select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(D, H)), D, E);
+        __m128i E3 = select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(H, F)), F, E);
+
+        _mm_storeu_si128((__m128i*)(out0 + 2 * x), _mm_unpacklo_epi32(E0, E1));
+        _mm_storeu_si128((__m128i*)(out0 + 2 * x + 4), _mm_unpackhi_epi32(E0, E1));
+        _mm_storeu_si128((__m128i*)(out1 + 2 * x), _mm_unpacklo_epi32(E2, E3));
+        _mm_storeu_si128((__m128i*)(out1 + 2 * x + 4), _mm_unpackhi_epi32(E2, E3));
+    }
+#endif
+    for (; x < width; x++)
+        epx2xPixel(out0, out1, above, row, below, x, width);
+}
+
+static void epx3xRow(uint32_t* out0, uint32_t* out1, uint32_t* out2, const uint32_t* above,
+                     const uint32_t* row, const uint32_t* below, int width)
+{
+    int x = 0;
+#ifdef SIMD_SSE2
+    epx3xPixel(out0, out1, out2, above, row, below, x++, width);
+    for (; x + 4 < width; x += 4)
+    {
+        __m128i A = _mm_loadu_si128((const __m128i*)(above + x - 1));
+        __m128i B = _mm_loadu_si128((const __m128i*)(above + x));
+        __m128i C = _mm_loadu_si128((const __m128i*)(above + x + 1));
+        __m128i D = _mm_loadu_si128((const __m128i*)(row + x - 1));
+        __m128i E = _mm_loadu_si128((const __m128i*)(row + x));
+        __m128i F = _mm_loadu_si128((const __m128i*)(row + x + 1));
+        __m128i G = _mm_loadu_si128((const __m128i*)(below + x - 1));
+        __m128i H = _mm_loadu_si128((const __m128i*)(below + x));
+        __m128i I = _mm_loadu_si128((const __m128i*)(below + x + 1));
+
+        __m128i edge = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+        __m128i DB = _mm_andnot_si128(edge, _mm_cmpeq_epi32(D, B));
+        __m128i BF = _mm_andnot_si128(edge, _mm_cmpeq_epi32(B, F));
+        __m128i DH = _mm_andnot_si128(edge, _mm_cmpeq_epi32(D, H));
+        __m128i HF = _mm_andnot_si128(edge, _mm_cmpeq_epi32(H, F));
+        __m128i EA = _mm_cmpeq_epi32(E, A), EC = _mm_cmpeq_epi32(E, C);
+        __m128i EG = _mm_cmpeq_epi32(E, G), EI = _mm_cmpeq_epi32(E, I);
+
+        __m128i E0 = select(DB, D, E);
+        __m128i E1 = select(_mm_or_si128(_mm_andnot_si128(EC, DB), _mm_andnot_si128(EA, BF)), B, E);
+        __m128i E2 = select(BF, F, E);
+        __m128i E3 = select(_mm_or_si128(_mm_andnot_si128(EG, DB), _mm_andnot_si128(EA, DH)), D, E);
+        __m128i E5 = select(_mm_or_si128(_mm_andnot_si128(EI, BF), _mm_andnot_si128(EC, HF)), F, E);
+        __m128i E6 = select(DH, D, E);
+        __m128i E7 = select(_mm_or_si128(_mm_andnot_si128(EI, DH), _mm_andnot_si128(EG, HF)), H, E);
+        __m128i E8 = select(HF, F, E);
+
+        store3(out0 + 3 * x, E0, E1, E2);
+        store3(out1 + 3 * x, E3, E, E5);
+        store3(out2 + 3 * x, E6, E7, E8);
+    }
+#endif
+    for (; x < width; x++)
+        epx3xPixel(out0, out1, out2, above, row, below, x, width);
+}
+
+// Efecto de scanlines: la fila queda al 75% de brillo
+static void darkenRow(uint32_t* row, int count)
+{
+    int x = 0;
+#ifdef SIMD_SSE2
+    const __m128i quarter = _mm_set1_epi32(0x003F3F3F);
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(row + x));
+        p = _mm_sub_epi32(p, _mm_and_si128(_mm_srli_epi32(p, 2), quarter));
+        _mm_storeu_si128((__m128i*)(row + x), p);
+    }
+#endif
+    for (; x < count; x++)
+        row[x] -= (row[x] >> 2) & 0x003F3F3F;
+}
+
+void scaleFrame(uint8_t* dst, int dstPitch, const uint8_t* src, int srcPitch,
+                int width, int height, int y0, int y1, const ScalerConfig& config)
+{
+    int factor = config.factor < 1 ? 1 : config.factor > 3 ? 3 : config.factor;
+
+    for (int y = y0; y < y1; y++)
+    {
+        const uint32_t* row = (const uint32_t*)(src + y * srcPitch);
+        const uint32_t* above = y > 0 ? (const uint32_t*)(src + (y - 1) * srcPitch) : row;
+        const uint32_t* below = y < height - 1 ? (const uint32_t*)(src + (y + 1) * srcPitch) : row;
+
+        uint32_t* out[3];
+        for (int i = 0; i < factor; i++)
+            out[i] = (uint32_t*)(dst + (y * factor + i) * dstPitch);
+
+        if (factor == 1)
+            memcpy(out[0], row, width * 4);
+        else if (config.filter == SCALE_EPX && factor == 2)
+            epx2xRow(out[0], out[1], above, row, below, width);
+        else if (config.filter == SCALE_EPX)
+            epx3xRow(out[0], out[1], out[2], above, row, below, width);
+        else
+        {
+            nearestRow(out[0], row, width, factor);
+            for (int i = 1; i < factor; i++)
+                memcpy(out[i], out[0], width * factor * 4);
+        }
+
+        if (config.scanlines && factor > 1)
+            darkenRow(out[factor - 1], width * factor);
+    }
+}
+
+void scaleRowsAffected(const ScalerConfig& config, int height, int& first, int& last)
+{
+    if (config.filter != SCALE_EPX || config.factor < 2)
+        return;
+    if (first > 0)
+        first--;
+    if (last < height - 1)
+        last++;
+}
@@ -0,0 +1,31 @@
+#ifndef _SCALER_H_
+#define _SCALER_H_
+
+#include <inttypes.h>
+
+// Escalado del frame ARGB8888 a un factor entero, directamente sobre el
+// buffer de salida (una textura bloqueada o la superficie de la ventana)
+enum ScaleFilter
+{
+    SCALE_NEAREST,      // vecino más próximo
+    SCALE_EPX           // Scale2x/EPX a 2x, Scale3x a 3x
+};
+
+struct ScalerConfig
+{
+    int factor;         // 1..3
+    ScaleFilter filter;
+    bool scanlines;     // oscurece la última fila de cada píxel escalado
+};
+
+// Escala las filas [y0, y1) de 'src' (width x height) en 'dst', que tiene
+// que medir width * factor x height * factor. Con SCALE_EPX cada fila
+// depende de la de arriba y la de abajo: si cambia la fila y hay que
+// volver a escalar también y - 1 e y + 1 (ver scaleRowsAffected).
+void scaleFrame(uint8_t* dst, int dstPitch, const uint8_t* src, int srcPitch,
+                int width, int height, int y0, int y1, const ScalerConfig& config);
+
+// Filas que hay que volver a escalar si han cambiado las [first, last]
+void scaleRowsAffected(const ScalerConfig& config, int height, int& first, int& last);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+// Extensiones SIMD que se pueden compilar. SSE2 está siempre en x86-64 (y
+// en x86 con -msse2 o /arch:SSE2); SSSE3 y AVX2 solo con GCC/Clang
+// (atributo target) o MSVC, y hay que comprobar la CPU antes de usarlas.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SIMD_X86_TARGETS 1
+#endif
+#endif
+
+#endif
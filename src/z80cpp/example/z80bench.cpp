@@ -0,0 +1,271 @@
+// Banco de pruebas de rendimiento del núcleo Z80 (instancia Z80sim).
+//
+// Ejecuta zexdoc/zexall (si están en el directorio indicado) y varios
+// kernels sintéticos, y saca por stdout una línea CSV por prueba:
+//
+//   test,result,instructions,tstates,seconds,mips,tstates_per_sec,ns_per_instr
+//
+// result es ok, fail o skip (fichero de zex no encontrado). Con varias
+// repeticiones (-r) se toma la más rápida. El código de salida es 1 si
+// alguna prueba falla.
+//
+// Uso: z80bench [-r repeticiones] [-d directorio_zex] [-v] [prueba ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "z80sim.h"
+
+using namespace std;
+
+// Los kernels se cargan en 0x100 y terminan con BDOS 0 (LD C,0 / CALL 5).
+// Cada uno lleva la huella (registros + RAM) que deja el núcleo al acabar;
+// si cambia, el núcleo ha dejado de ser exacto.
+
+// Aritmética y lógica de 8/16 bits, rotaciones y DAA, sin accesos a memoria
+static const uint8_t kernelAlu[] = {
+    0xD9,                   // 0100 EXX
+    0x0E, 0x20,             // 0101 LD C,20h       ; 32 pasadas
+    0xD9,                   // 0103 EXX
+    0x16, 0x00,             // 0104 LD D,0
+    0x06, 0x00,             // 0106 LD B,0
+    0x80,                   // 0108 ADD A,B
+    0x89,                   // 0109 ADC A,C
+    0x93,                   // 010A SUB E
+    0x9C,                   // 010B SBC A,H
+    0xA5,                   // 010C AND L
+    0xA8,                   // 010D XOR B
+    0xB1,                   // 010E OR C
+    0xBA,                   // 010F CP D
+    0x0C,                   // 0110 INC C
+    0x1D,                   // 0111 DEC E
+    0xC6, 0x37,             // 0112 ADD A,37h
+    0x07,                   // 0114 RLCA
+    0x27,                   // 0115 DAA
+    0x24,                   // 0116 INC H
+    0x09,                   // 0117 ADD HL,BC
+    0xED, 0x52,             // 0118 SBC HL,DE
+    0xED, 0x44,             // 011A NEG
+    0xCB, 0x15,             // 011C RL L
+    0xCB, 0x3C,             // 011E SRL H
+    0x10, 0xE6,             // 0120 DJNZ 0108h
+    0x15,                   // 0122 DEC D
+    0xC2, 0x06, 0x01,       // 0123 JP NZ,0106h
+    0xD9,                   // 0126 EXX
+    0x0D,                   // 0127 DEC C
+    0xD9,                   // 0128 EXX
+    0xC2, 0x04, 0x01,       // 0129 JP NZ,0104h
+    0x0E, 0x00,             // 012C LD C,0
+    0xCD, 0x05, 0x00,       // 012E CALL 5         ; BDOS 0: fin
+};
+// Cargas y escrituras por (HL)/(DE)/(nn), pila y EX (SP),HL
+static const uint8_t kernelMemory[] = {
+    0x31, 0x00, 0xF0,       // 0100 LD SP,F000h
+    0x3E, 0x80,             // 0103 LD A,80h       ; 128 pasadas
+    0x32, 0x00, 0xE0,       // 0105 LD (E000h),A
+    0x21, 0x00, 0x40,       // 0108 LD HL,4000h
+    0x11, 0x00, 0x80,       // 010B LD DE,8000h
+    0x01, 0x00, 0x10,       // 010E LD BC,1000h
+    0x7E,                   // 0111 LD A,(HL)
+    0x12,                   // 0112 LD (DE),A
+    0x23,                   // 0113 INC HL
+    0x13,                   // 0114 INC DE
+    0x34,                   // 0115 INC (HL)
+    0x1A,                   // 0116 LD A,(DE)
+    0x77,                   // 0117 LD (HL),A
+    0xE5,                   // 0118 PUSH HL
+    0xD5,                   // 0119 PUSH DE
+    0xE3,                   // 011A EX (SP),HL
+    0xD1,                   // 011B POP DE
+    0xE1,                   // 011C POP HL
+    0x22, 0x02, 0xE0,       // 011D LD (E002h),HL
+    0x2A, 0x02, 0xE0,       // 0120 LD HL,(E002h)
+    0x0B,                   // 0123 DEC BC
+    0x78,                   // 0124 LD A,B
+    0xB1,                   // 0125 OR C
+    0x20, 0xE9,             // 0126 JR NZ,0111h
+    0x3A, 0x00, 0xE0,       // 0128 LD A,(E000h)
+    0x3D,                   // 012B DEC A
+    0xC2, 0x05, 0x01,       // 012C JP NZ,0105h
+    0x0E, 0x00,             // 012F LD C,0
+    0xCD, 0x05, 0x00,       // 0131 CALL 5         ; BDOS 0: fin
+};
+// LDIR/LDDR/CPIR/CPDR largos
+static const uint8_t kernelBlock[] = {
+    0x3E, 0x00,             // 0100 LD A,0         ; 256 pasadas
+    0x32, 0x00, 0xF0,       // 0102 LD (F000h),A
+    0x21, 0x00, 0x01,       // 0105 LD HL,0100h
+    0x11, 0x00, 0x40,       // 0108 LD DE,4000h
+    0x01, 0x00, 0x40,       // 010B LD BC,4000h
+    0xED, 0xB0,             // 010E LDIR
+    0x21, 0x00, 0x80,       // 0110 LD HL,8000h
+    0x11, 0x01, 0x80,       // 0113 LD DE,8001h
+    0x01, 0x00, 0x20,       // 0116 LD BC,2000h
+    0xED, 0xB0,             // 0119 LDIR           ; relleno
+    0x21, 0xFF, 0x7F,       // 011B LD HL,7FFFh
+    0x11, 0xFF, 0xBF,       // 011E LD DE,BFFFh
+    0x01, 0x00, 0x40,       // 0121 LD BC,4000h
+    0xED, 0xB8,             // 0124 LDDR
+    0x21, 0x00, 0x80,       // 0126 LD HL,8000h
+    0x01, 0x00, 0x40,       // 0129 LD BC,4000h
+    0x3E, 0xC9,             // 012C LD A,C9h
+    0xED, 0xB1,             // 012E CPIR
+    0x21, 0xFF, 0xBF,       // 0130 LD HL,BFFFh
+    0x01, 0x00, 0x40,       // 0133 LD BC,4000h
+    0x3E, 0x01,             // 0136 LD A,01h
+    0xED, 0xB9,             // 0138 CPDR
+    0x3A, 0x00, 0xF0,       // 013A LD A,(F000h)
+    0x3D,                   // 013D DEC A
+    0xC2, 0x02, 0x01,       // 013E JP NZ,0102h
+    0x0E, 0x00,             // 0141 LD C,0
+    0xCD, 0x05, 0x00,       // 0143 CALL 5         ; BDOS 0: fin
+};
+// Instrucciones prefijadas DD/FD y DDCB/FDCB
+static const uint8_t kernelIndex[] = {
+    0x31, 0x00, 0xF0,       // 0100 LD SP,F000h
+    0xDD, 0x21, 0x00, 0x80, // 0103 LD IX,8000h
+    0xFD, 0x21, 0x00, 0xA0, // 0107 LD IY,A000h
+    0xD9,                   // 010B EXX
+    0x0E, 0x10,             // 010C LD C,10h       ; 16 x 128 pasadas
+    0xD9,                   // 010E EXX
+    0x16, 0x80,             // 010F LD D,80h
+    0x06, 0x00,             // 0111 LD B,0
+    0xDD, 0x7E, 0x00,       // 0113 LD A,(IX+0)
+    0xFD, 0x86, 0x01,       // 0116 ADD A,(IY+1)
+    0xDD, 0x77, 0x02,       // 0119 LD (IX+2),A
+    0xFD, 0x34, 0x03,       // 011C INC (IY+3)
+    0xDD, 0xAE, 0xFF,       // 011F XOR (IX-1)
+    0xFD, 0xBE, 0x04,       // 0122 CP (IY+4)
+    0xDD, 0xCB, 0x05, 0x5E, // 0125 BIT 3,(IX+5)
+    0xFD, 0xCB, 0x06, 0xC6, // 0129 SET 0,(IY+6)
+    0xDD, 0xCB, 0x07, 0x16, // 012D RL (IX+7)
+    0xDD, 0x6F,             // 0131 LD IXL,A
+    0xFD, 0x26, 0xA0,       // 0133 LD IYH,A0h
+    0xDD, 0x19,             // 0136 ADD IX,DE
+    0xDD, 0x26, 0x80,       // 0138 LD IXH,80h
+    0xFD, 0xE5,             // 013B PUSH IY
+    0xFD, 0xE1,             // 013D POP IY
+    0xDD, 0x23,             // 013F INC IX
+    0xFD, 0x2B,             // 0141 DEC IY
+    0x10, 0xCE,             // 0143 DJNZ 0113h
+    0x15,                   // 0145 DEC D
+    0xC2, 0x11, 0x01,       // 0146 JP NZ,0111h
+    0xD9,                   // 0149 EXX
+    0x0D,                   // 014A DEC C
+    0xD9,                   // 014B EXX
+    0xC2, 0x0F, 0x01,       // 014C JP NZ,010Fh
+    0x0E, 0x00,             // 014F LD C,0
+    0xCD, 0x05, 0x00,       // 0151 CALL 5         ; BDOS 0: fin
+};
+
+struct BenchTest {
+    const char *name;
+    const uint8_t *code;    // nullptr: programa zex leído de disco
+    size_t size;
+    uint32_t checksum;
+};
+
+static const BenchTest tests[] = {
+    { "alu", kernelAlu, sizeof(kernelAlu), 0x658A89B6 },
+    { "memory", kernelMemory, sizeof(kernelMemory), 0x2172E460 },
+    { "block", kernelBlock, sizeof(kernelBlock), 0x2D789A3A },
+    { "index", kernelIndex, sizeof(kernelIndex), 0xDEBBE110 },
+    { "zexdoc", nullptr, 0, 0 },
+    { "zexall", nullptr, 0, 0 },
+};
+
+static bool readZex(const string &dir, const char *name, vector<uint8_t> &program)
+{
+    static const char *exts[] = { ".com", ".bin", ".COM", ".BIN" };
+
+    for (const char *ext : exts) {
+        ifstream f(dir + "/" + name + ext, ios::in | ios::binary | ios::ate);
+        if (!f.is_open())
+            continue;
+        program.resize((size_t) f.tellg());
+        f.seekg(0, ios::beg);
+        f.read((char *) program.data(), program.size());
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = 1;
+    string zexDir = ".";
+    bool verbose = false;
+    vector<string> only;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            runs = max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            zexDir = argv[++i];
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+            only.push_back(argv[i]);
+    }
+
+    // Z80sim lleva 128 KB de memoria y puertos: mejor en el heap
+    Z80sim *sim = new Z80sim();
+    sim->setEcho(verbose);
+    bool failed = false;
+
+    printf("test,result,instructions,tstates,seconds,mips,tstates_per_sec,ns_per_instr\n");
+
+    for (const BenchTest &test : tests) {
+        if (!only.empty() && find(only.begin(), only.end(), test.name) == only.end())
+            continue;
+
+        vector<uint8_t> program;
+        if (test.code != nullptr) {
+            program.assign(test.code, test.code + test.size);
+        } else if (!readZex(zexDir, test.name, program)) {
+            printf("%s,skip,0,0,0,0,0,0\n", test.name);
+            continue;
+        }
+
+        double best = 0;
+        bool ok = true;
+        for (int run = 0; run < runs; run++) {
+            sim->loadProgram(program.data(), program.size());
+            auto start = chrono::steady_clock::now();
+            bool finished = sim->run();
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+            if (test.code != nullptr) {
+                ok = ok && finished && sim->getChecksum() == test.checksum;
+                if (verbose)
+                    fprintf(stderr, "%s: checksum %08X\n", test.name, sim->getChecksum());
+            } else {
+                const string &out = sim->getConsole();
+                ok = ok && finished && out.find("ERROR") == string::npos
+                        && out.find("Tests complete") != string::npos;
+            }
+
+            if (run == 0 || elapsed.count() < best)
+                best = elapsed.count();
+        }
+
+        double instructions = (double) sim->getInstructions();
+        double tstates = (double) sim->getTotalTstates();
+        printf("%s,%s,%llu,%llu,%.6f,%.3f,%.0f,%.3f\n", test.name, ok ? "ok" : "fail",
+               (unsigned long long) sim->getInstructions(),
+               (unsigned long long) sim->getTotalTstates(), best,
+               instructions / best / 1e6, tstates / best,
+               best * 1e9 / instructions);
+        fflush(stdout);
+        failed |= !ok;
+    }
+
+    delete sim;
+    return failed ? 1 : 0;
+}
@@ -1,10 +1,16 @@
+#include <string.h>
+#include <vector>
+
 #include "z80sim.h"
 
 using namespace std;
 
 Z80sim::Z80sim(void) : cpu(this)
 {
-
+    tstates = 0;
+    instructions = 0;
+    finish = false;
+    echo = true;
 }
 
 Z80sim::~Z80sim() {}
@@ -73,6 +79,10 @@ bool Z80sim::isActiveINT(void) {
     return false;
 }
 
+uint32_t Z80sim::getTstates(void) {
+    return static_cast<uint32_t>(tstates);
+}
+
 #ifdef WITH_EXEC_DONE
 void Z80sim::execDone(void) {}
 #endif
@@ -88,22 +98,29 @@ uint8_t Z80sim::breakpoint(uint16_t address, uint8_t opcode) {
     switch (cpu.getRegC()) {
         case 0: // BDOS 0 System Reset
         {
-            cout << "Z80 reset after " << tstates << " t-states" << endl;
+            if (echo)
+                cout << "Z80 reset after " << tstates << " t-states" << endl;
             finish = true;
             break;
         }
         case 2: // BDOS 2 console char output
         {
-            cout << (char) cpu.getRegE();
+            console += (char) cpu.getRegE();
+            if (echo)
+                cout << (char) cpu.getRegE();
             break;
         }
         case 9: // BDOS 9 console string output (string terminated by "$")
         {
             uint16_t strAddr = cpu.getRegDE();
+            size_t start = console.size();
             while (z80Ram[strAddr] != '$') {
-                cout << (char) z80Ram[strAddr++];
+                console += (char) z80Ram[strAddr++];
+            }
+            if (echo) {
+                cout << console.substr(start);
+                cout.flush();
             }
-            cout.flush();
             break;
         }
         default:
@@ -117,42 +134,71 @@ uint8_t Z80sim::breakpoint(uint16_t address, uint8_t opcode) {
     return opcode;
 }
 
-void Z80sim::runTest(std::ifstream* f) {
-    streampos size;
-    if (!f->is_open()) {
-        cout << "file NOT OPEN" << endl;
-        return;
-    } else cout << "file open" << endl;
-
-    size = f->tellg();
-    cout << "Test size: " << size << endl;
-    f->seekg(0, ios::beg);
-    f->read((char *) &z80Ram[0x100], size);
-    f->close();
+void Z80sim::loadProgram(const uint8_t *code, size_t size) {
+    memset(z80Ram, 0, sizeof(z80Ram));
+    memset(z80Ports, 0, sizeof(z80Ports));
+    if (size > sizeof(z80Ram) - 0x100)
+        size = sizeof(z80Ram) - 0x100;
+    memcpy(&z80Ram[0x100], code, size);
 
 #ifdef WITH_BREAKPOINT_SUPPORT
     cpu.setBreakpoint(true);
 #endif
 
     cpu.reset();
+    tstates = 0;
+    instructions = 0;
+    console.clear();
     finish = false;
 
     z80Ram[0] = (uint8_t) 0xC3;
     z80Ram[1] = 0x00;
     z80Ram[2] = 0x01; // JP 0x100 CP/M TPA
     z80Ram[5] = (uint8_t) 0xC9; // Return from BDOS call
+}
 
-    while (!finish) {
+bool Z80sim::run(uint64_t maxInstructions) {
+    while (!finish && instructions < maxInstructions) {
         cpu.execute();
+        instructions++;
+    }
+    return finish;
+}
+
+bool Z80sim::runTest(std::ifstream* f) {
+    streampos size;
+    if (!f->is_open()) {
+        cout << "file NOT OPEN" << endl;
+        return false;
     }
+
+    size = f->tellg();
+    if (echo)
+        cout << "Test size: " << size << endl;
+
+    vector<uint8_t> program((size_t) size);
+    f->seekg(0, ios::beg);
+    f->read((char *) program.data(), size);
+    f->close();
+
+    loadProgram(program.data(), program.size());
+    return run();
 }
 
-//int main(void) {
-//
-//    Z80sim sim = Z80sim();
-//
-//    ifstream f1("zexall.bin", ios::in | ios::binary | ios::ate);
-//    sim.runTest(&f1);
-//    f1.close();
-//
-//}
+uint32_t Z80sim::getChecksum(void) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    const uint16_t regs[] = { cpu.getRegAF(), cpu.getRegBC(), cpu.getRegDE(), cpu.getRegHL(),
+                              cpu.getRegIX(), cpu.getRegIY(), cpu.getRegSP() };
+
+    for (uint16_t reg : regs) {
+        hash = (hash ^ (reg & 0xff)) * 16777619u;
+        hash = (hash ^ (reg >> 8)) * 16777619u;
+    }
+
+    for (uint32_t address = 0; address < sizeof(z80Ram); address++) {
+        hash = (hash ^ z80Ram[address]) * 16777619u;
+    }
+
+    return hash;
+}
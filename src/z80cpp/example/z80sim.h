@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
 
 #include "z80.h"
 #include "z80operations.h"
@@ -15,6 +16,11 @@ private:
     uint8_t z80Ram[0x10000];
     uint8_t z80Ports[0x10000];
     bool finish;
+    // Instrucciones ejecutadas desde loadProgram()
+    uint64_t instructions;
+    // Salida de consola CP/M (BDOS 2 y 9) y si se copia a cout
+    std::string console;
+    bool echo;
 
 public:
     Z80sim(void);
@@ -30,6 +36,7 @@ public:
     void addressOnBus(uint16_t address, int32_t tstates) override;
     void interruptHandlingTime(int32_t tstates) override;
     bool isActiveINT(void) override;
+    uint32_t getTstates(void) override;
 
 #ifdef WITH_BREAKPOINT_SUPPORT
     uint8_t breakpoint(uint16_t address, uint8_t opcode) override;
@@ -41,6 +48,18 @@ public:
     void execDone(void) override;
 #endif
 
-    void runTest(std::ifstream* f);
+    // Carga un programa CP/M en 0x100 con la RAM a cero y resetea la CPU
+    void loadProgram(const uint8_t *code, size_t size);
+    // Ejecuta hasta el BDOS 0 o hasta agotar 'maxInstructions'.
+    // Devuelve true si el programa terminó.
+    bool run(uint64_t maxInstructions = UINT64_MAX);
+    bool runTest(std::ifstream* f);
+
+    void setEcho(bool state) { echo = state; }
+    const std::string &getConsole(void) const { return console; }
+    uint64_t getInstructions(void) const { return instructions; }
+    uint64_t getTotalTstates(void) const { return tstates; }
+    // Huella de los registros y de la RAM, para validar los kernels
+    uint32_t getChecksum(void);
 };
 #endif // Z80SIM_H